@@ -4,16 +4,26 @@
 
 //include libs and things
 #include "util.hpp"
+#include "sim_clock.hpp"
+#include "job_system.hpp"
 #include "renderer.hpp"
 #include "screen.hpp"
 #include "input.hpp"
 #include "CeleritObject.hpp"
 #include "sprite.hpp"
 #include "level.hpp"
+#include "tilemap.hpp"
+#include "aabb_tree.hpp"
 #include "font.hpp"
+#include "asset_loader.hpp"
+#include "asset_archive.hpp"
+#include "texture_atlas.hpp"
 #include "text_stream.hpp"
 #include "UI.hpp"
 #include "Particle.hpp"
+#include "frame_pipeline.hpp"
+#include "ecs.hpp"
+#include "profiler_overlay.hpp"
 
 //Initalize necessary SDL components and things
 inline void CELERIT_INIT() {
@@ -23,6 +33,14 @@ inline void CELERIT_INIT() {
     Mix_Init(MIX_INIT_MP3);
 }
 
+//Initalize SDL without needing a display or sound card, for headless screens on build machines
+//the dummy drivers are only used if SDL_VIDEODRIVER and SDL_AUDIODRIVER arent already set
+inline void CELERIT_INIT_HEADLESS() {
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    CELERIT_INIT();
+}
+
 //Clean up
 inline void CELERIT_QUIT() {
     SDL_Quit();
@@ -20,6 +20,9 @@ class CObject {
         obj_name = "CObject";
     }
 
+    //virtual so containers like sprite_group can delete objects through a base pointer
+    virtual ~CObject() {}
+
     string to_string() {
         stringstream ss;
         ss << "<" << this << ">" << "[" << obj_name << "]";
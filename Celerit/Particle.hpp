@@ -3,6 +3,13 @@
 
 #include "util.hpp"
 #include "renderer.hpp"
+#include "texture_atlas.hpp"
+#include "job_system.hpp"
+#include "render_snapshot.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 
 namespace Particle {
@@ -58,6 +65,17 @@ namespace Particle {
             last_update_time = getUTCTime();
         }
 
+        Instance(dvec2 pos, dvec2 vel, dvec2 acc, seconds_t life_span, seconds_t original_life, bool rotate_to_velocity, seconds_t timestamp) {
+            //creates an instance without reading the clock, used when handing particles out of a Particle::store
+            position = pos;
+            velocity = vel;
+            acceleration = acc;
+            remaining_life_span = life_span;
+            rotate_with_velocity = rotate_to_velocity;
+            original_life_span = original_life;
+            last_update_time = timestamp;
+        }
+
         bool isAlive() {
             return remaining_life_span > 0;
         }
@@ -76,6 +94,205 @@ namespace Particle {
         }
 
     };
+
+
+    //the update rate particle velocities and accelerations are given for, they move by that much once per update() call,
+    //and update(dt) scales them so a fixed step at this rate moves particles exactly as far as one update() does
+    constexpr double NOMINAL_RATE = 60.0;
+
+
+    inline void integrate(float* pos_x, float* pos_y, float* vel_x, float* vel_y, const float* acc_x, const float* acc_y, float* life, int count, float dt, float motion_scale = 1.0f) {
+        /*
+        the particle update kernel, for every particle that is still alive:
+        position += velocity*motion_scale, velocity += acceleration*motion_scale, life -= dt
+        a motion_scale of 1 moves particles by their velocity once per update, a motion_scale of dt makes velocity per second
+        (the emitters use dt * NOMINAL_RATE, so velocities mean the same in update() and update(dt))
+        dead particles are masked out rather than branched on so the whole range can be done 8 (AVX) or 4 (SSE) at a time
+        the AVX loop is only compiled in when the compiler targets AVX, for example with the CELERIT_AVX2 cmake option
+        */
+        int i = 0;
+
+        #if defined(__AVX__)
+        __m256 zero8 = _mm256_setzero_ps();
+        __m256 dt8 = _mm256_set1_ps(dt);
+        __m256 k8 = _mm256_set1_ps(motion_scale);
+        for (; i + 8 <= count; i += 8) {
+            __m256 l = _mm256_loadu_ps(life + i);
+            __m256 alive = _mm256_cmp_ps(l, zero8, _CMP_GT_OQ);
+            __m256 vx = _mm256_loadu_ps(vel_x + i);
+            __m256 vy = _mm256_loadu_ps(vel_y + i);
+
+            _mm256_storeu_ps(pos_x + i, _mm256_add_ps(_mm256_loadu_ps(pos_x + i), _mm256_and_ps(_mm256_mul_ps(vx, k8), alive)));
+            _mm256_storeu_ps(pos_y + i, _mm256_add_ps(_mm256_loadu_ps(pos_y + i), _mm256_and_ps(_mm256_mul_ps(vy, k8), alive)));
+            _mm256_storeu_ps(vel_x + i, _mm256_add_ps(vx, _mm256_and_ps(_mm256_mul_ps(_mm256_loadu_ps(acc_x + i), k8), alive)));
+            _mm256_storeu_ps(vel_y + i, _mm256_add_ps(vy, _mm256_and_ps(_mm256_mul_ps(_mm256_loadu_ps(acc_y + i), k8), alive)));
+            _mm256_storeu_ps(life + i, _mm256_sub_ps(l, _mm256_and_ps(dt8, alive)));
+        }
+        #endif
+
+        #if defined(__SSE2__) || defined(_M_X64)
+        __m128 zero4 = _mm_setzero_ps();
+        __m128 dt4 = _mm_set1_ps(dt);
+        __m128 k4 = _mm_set1_ps(motion_scale);
+        for (; i + 4 <= count; i += 4) {
+            __m128 l = _mm_loadu_ps(life + i);
+            __m128 alive = _mm_cmpgt_ps(l, zero4);
+            __m128 vx = _mm_loadu_ps(vel_x + i);
+            __m128 vy = _mm_loadu_ps(vel_y + i);
+
+            _mm_storeu_ps(pos_x + i, _mm_add_ps(_mm_loadu_ps(pos_x + i), _mm_and_ps(_mm_mul_ps(vx, k4), alive)));
+            _mm_storeu_ps(pos_y + i, _mm_add_ps(_mm_loadu_ps(pos_y + i), _mm_and_ps(_mm_mul_ps(vy, k4), alive)));
+            _mm_storeu_ps(vel_x + i, _mm_add_ps(vx, _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(acc_x + i), k4), alive)));
+            _mm_storeu_ps(vel_y + i, _mm_add_ps(vy, _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(acc_y + i), k4), alive)));
+            _mm_storeu_ps(life + i, _mm_sub_ps(l, _mm_and_ps(dt4, alive)));
+        }
+        #endif
+
+        //whatever is left over (or everything, without SIMD)
+        for (; i < count; i++) {
+            if (life[i] <= 0) continue;
+            pos_x[i] += vel_x[i]*motion_scale;
+            pos_y[i] += vel_y[i]*motion_scale;
+            vel_x[i] += acc_x[i]*motion_scale;
+            vel_y[i] += acc_y[i]*motion_scale;
+            life[i] -= dt;
+        }
+    }
+
+
+    struct store {
+        /*
+        structure of arrays storage for particles, every field lives in its own contiguous float array
+        so that the update kernel can stream through them, see Particle::integrate
+        alive particles are always packed into [0, alive_count()), dead ones get swapped out of the way,
+        so spawning is O(1) per particle and updating and drawing only ever touch alive particles
+        */
+
+        public:
+        //particles per job in store::integrate(job_system&, ...), smaller stores arent worth splitting up
+        static constexpr int PARALLEL_CHUNK = 4096;
+
+        std::vector<float> pos_x;
+        std::vector<float> pos_y;
+        std::vector<float> vel_x;
+        std::vector<float> vel_y;
+        std::vector<float> acc_x;
+        std::vector<float> acc_y;
+        std::vector<float> life;
+        std::vector<float> original_life;
+        std::vector<uint8_t> rotate_with_velocity;
+
+        protected:
+        int alive = 0;
+
+        public:
+
+        void resize(int n) {
+            //resizes the store, new particles start out dead, shrinking kills particles past the new size
+            pos_x.resize(n, 0);
+            pos_y.resize(n, 0);
+            vel_x.resize(n, 0);
+            vel_y.resize(n, 0);
+            acc_x.resize(n, 0);
+            acc_y.resize(n, 0);
+            life.resize(n, 0);
+            original_life.resize(n, 0);
+            rotate_with_velocity.resize(n, false);
+            alive = std::min(alive, n);
+        }
+
+        int size() const {
+            //the capacity of the store
+            return static_cast<int>(life.size());
+        }
+
+        int alive_count() const {
+            //how many particles are alive, they are the first alive_count() particles
+            return alive;
+        }
+
+        int spawn(kinematics kin, seconds_t life_span, bool rotate_to_velocity) {
+            //brings a particle to life at the end of the alive range, returns its index or -1 if the store is full
+            if (alive == size() || life_span <= 0) return -1;
+            set(alive, kin, life_span, rotate_to_velocity);
+            return alive++;
+        }
+
+        void kill(int i) {
+            //kills a particle by moving the last alive particle into its slot, so the index now holds a different particle
+            int last = --alive;
+            if (i != last) {
+                pos_x[i] = pos_x[last];
+                pos_y[i] = pos_y[last];
+                vel_x[i] = vel_x[last];
+                vel_y[i] = vel_y[last];
+                acc_x[i] = acc_x[last];
+                acc_y[i] = acc_y[last];
+                life[i] = life[last];
+                original_life[i] = original_life[last];
+                rotate_with_velocity[i] = rotate_with_velocity[last];
+            }
+            life[last] = 0;
+        }
+
+        void compact() {
+            //swaps every particle that has run out of life out of the alive range
+            for (int i = 0; i < alive;) {
+                if (life[i] <= 0) {
+                    kill(i);
+                } else {
+                    i++;
+                }
+            }
+        }
+
+        bool is_alive(int i) const {
+            return life[i] > 0;
+        }
+
+        void set(int i, kinematics kin, seconds_t life_span, bool rotate_to_velocity) {
+            //(re)initializes a particle
+            pos_x[i] = static_cast<float>(kin.position.x);
+            pos_y[i] = static_cast<float>(kin.position.y);
+            vel_x[i] = static_cast<float>(kin.velocity.x);
+            vel_y[i] = static_cast<float>(kin.velocity.y);
+            acc_x[i] = static_cast<float>(kin.acceleration.x);
+            acc_y[i] = static_cast<float>(kin.acceleration.y);
+            life[i] = static_cast<float>(life_span);
+            original_life[i] = static_cast<float>(life_span);
+            rotate_with_velocity[i] = rotate_to_velocity;
+        }
+
+        dvec2 get_position(int i) const {
+            return {pos_x[i], pos_y[i]};
+        }
+
+        dvec2 get_velocity(int i) const {
+            return {vel_x[i], vel_y[i]};
+        }
+
+        Instance get_instance(int i, seconds_t timestamp) const {
+            //copies a particle out as an Instance, for code that still works with instances
+            return Instance(get_position(i), get_velocity(i), {acc_x[i], acc_y[i]}, life[i], original_life[i], rotate_with_velocity[i], timestamp);
+        }
+
+        void integrate(seconds_t dt, float motion_scale = 1.0f) {
+            //updates every alive particle by one step, dt seconds of life are taken off each, then the ones that died are removed
+            //see Particle::integrate for motion_scale
+            Particle::integrate(pos_x.data(), pos_y.data(), vel_x.data(), vel_y.data(), acc_x.data(), acc_y.data(), life.data(), alive, static_cast<float>(dt), motion_scale);
+            compact();
+        }
+
+        void integrate(job_system& jobs, seconds_t dt, float motion_scale = 1.0f) {
+            //the same as store::integrate, with the alive range split into chunks across the job systems workers
+            //chunks are a multiple of 8 particles so every chunk but the last runs entirely in the SIMD loops
+            jobs.parallel_for(0, alive, [&](int first, int last) {
+                Particle::integrate(pos_x.data() + first, pos_y.data() + first, vel_x.data() + first, vel_y.data() + first,
+                                    acc_x.data() + first, acc_y.data() + first, life.data() + first, last - first, static_cast<float>(dt), motion_scale);
+            }, PARALLEL_CHUNK);
+            compact();
+        }
+    };
 }
 
 
@@ -90,7 +307,16 @@ class ParticleEmitter {
     protected:
 
     texture image;
-    Instance* instances;
+    //set by ParticleEmitter::set_image, then particles are drawn from this part of image instead of all of it
+    bool use_source = false;
+    rect image_source = {{0, 0, 0, 0}};
+    //the emitter made image itself (rather than being handed one) so it has to destroy it
+    bool owns_image = true;
+    Particle::store particles;
+    //one clock read per update, shared by every particle
+    seconds_t last_update_time;
+    //whether the emitter is being driven with update(dt), in which case the clock isnt used at all
+    bool fixed_step = false;
     int MAX_PARTICLES;
     int w;
     int h;
@@ -108,7 +334,8 @@ class ParticleEmitter {
     ParticleEmitter(renderer& r, dvec2 position, int max_particles, int instance_width, int instance_height, emission_BEHAVIOR behavior = Particle::LINEAR) : 
     image(r, instance_width, instance_height) {
         MAX_PARTICLES = max_particles;
-        instances = (Instance*)malloc(sizeof(Instance) * max_particles);
+        particles.resize(max_particles);
+        last_update_time = getUTCTime();
         rend = &r;
         w = instance_width;
         h = instance_height;
@@ -117,10 +344,6 @@ class ParticleEmitter {
         rend->reset_target();
         this->behavior = behavior;
 
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            instances[i] = Instance({0, 0}, {0, 0}, {0, 0}, 0.0);
-        }
-
         this->position = position;
     }
 
@@ -128,6 +351,22 @@ class ParticleEmitter {
         scroll = &vec;
     }
 
+    void set_image(texture& t, rect source) {
+        //draws particles with part of another texture instead of the emitters own image, particles take the size of <source>
+        if (owns_image) rend->destroy_texture(image);
+        owns_image = false;
+        image = t;
+        use_source = true;
+        image_source = source;
+        w = source.w;
+        h = source.h;
+    }
+
+    void set_image(atlas_region region) {
+        //draws particles with an image from a texture_atlas, so emitters sharing an atlas page batch together
+        set_image(region.get_texture(), region.get_source());
+    }
+
     void set_rotate_with_velocity(bool val) {
         rotate_with_velocity = val;
     }
@@ -149,36 +388,74 @@ class ParticleEmitter {
 
 
     void draw() {
+        CELERIT_PROFILE_ZONE("particles::draw");
         dvec2 pos_offset = {0, 0};
         if (scroll != nullptr) {
             pos_offset = *scroll;
         }
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            if (instances[i].isAlive()) {
-                if (instances[i].rotate_with_velocity) {
-                    rend->blit_texture(image, instances[i].position-pos_offset, instances[i].velocity.get_horizantal_angle(),
-                                        dvec2{static_cast<double>((double)w/2.0), static_cast<double>((double)h/2.0)});
-                } else {
-                    rend->blit_texture(image, instances[i].position-pos_offset);
-                }
+        for (int i = 0; i < particles.alive_count(); i++) {
+            if (use_source) {
+                ivec2 p = (particles.get_position(i)-pos_offset).convert_data<int>();
+                double angle = particles.rotate_with_velocity[i] ? particles.get_velocity(i).get_horizantal_angle() : 0.0;
+                rend->blit_texture(image, image_source, rect{{p.x, p.y, w, h}}, angle, dvec2{(double)w/2.0, (double)h/2.0});
+            } else if (particles.rotate_with_velocity[i]) {
+                rend->blit_texture(image, particles.get_position(i)-pos_offset, particles.get_velocity(i).get_horizantal_angle(),
+                                    dvec2{static_cast<double>((double)w/2.0), static_cast<double>((double)h/2.0)});
+            } else {
+                rend->blit_texture(image, particles.get_position(i)-pos_offset);
+            }
+        }
+    }
+
+    void capture(render_snapshot& snap) {
+        //copies the particles into a snapshot as the same quads ParticleEmitter::draw would draw
+        dvec2 pos_offset = {0, 0};
+        if (scroll != nullptr) {
+            pos_offset = *scroll;
+        }
+        rect full = image.get_rect();
+        dvec2 center = {(double)w/2.0, (double)h/2.0};
+        snap.quads.reserve(snap.quads.size() + particles.alive_count());
+        for (int i = 0; i < particles.alive_count(); i++) {
+            dvec2 p = particles.get_position(i)-pos_offset;
+            double angle = particles.rotate_with_velocity[i] ? particles.get_velocity(i).get_horizantal_angle() : 0.0;
+            if (use_source) {
+                ivec2 ip = p.convert_data<int>();
+                snap.add(image, image_source, rect{{ip.x, ip.y, w, h}}, angle, center);
+            } else {
+                snap.add(image, full, rect{{static_cast<int>(round(p.x)), static_cast<int>(round(p.y)), full.w, full.h}}, angle, center);
             }
         }
     }
 
     void update() {
         //updates all particles
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            instances[i].update();
-        }
+        CELERIT_PROFILE_ZONE("particles::update");
+        seconds_t now = getUTCTime();
+        particles.integrate(now - last_update_time);
+        last_update_time = now;
+        fixed_step = false;
     }
 
-    int get_alive_particles() {
-        int c = 0;
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            c += instances[i].isAlive();
-        }
+    void update(seconds_t dt) {
+        /*
+        updates all particles by a fixed amount of time, meant to be driven by a sim_clock
+        motion is scaled by dt against Particle::NOMINAL_RATE, so particles move the same as with update() but independent of the step rate
+        */
+        CELERIT_PROFILE_ZONE("particles::update");
+        particles.integrate(dt, static_cast<float>(dt * Particle::NOMINAL_RATE));
+        fixed_step = true;
+    }
 
-        return c;
+    void update(seconds_t dt, job_system& jobs) {
+        //the same as update(dt), with the particles split up across the job systems workers
+        CELERIT_PROFILE_ZONE("particles::update");
+        particles.integrate(jobs, dt, static_cast<float>(dt * Particle::NOMINAL_RATE));
+        fixed_step = true;
+    }
+
+    int get_alive_particles() {
+        return particles.alive_count();
     }
 
 
@@ -208,6 +485,8 @@ class ParticleEmitter {
     void spawn_particles(int amount) {
         //spawns **amount** particles so long as the number of alive particles plus amount is less than max particles
         int spawn_count = 0;
+        //particles spawned between updates shouldnt lose the time from before they existed on the next update
+        seconds_t life_span = fixed_step ? 10 : 10 + (getUTCTime() - last_update_time);
         kinematics init_kin = get_initial_kinematics();
         arcdegrees emission_angle = emission_vector.get_horizantal_angle() + spread_angle_current;
 
@@ -219,36 +498,27 @@ class ParticleEmitter {
         if (!alternating_dir) init_kin.velocity = init_kin.velocity.get_opposite();
         if (!alternating_dir) init_kin.acceleration = init_kin.acceleration.get_opposite();
 
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            if (!instances[i].isAlive()) {
-                instances[i] = Instance(init_kin.position, init_kin.velocity, init_kin.acceleration, 
-                10, rotate_with_velocity);
+        while (spawn_count < amount) {
+            if (particles.spawn(init_kin, life_span, rotate_with_velocity) == -1) break;
 
-                spawn_count++;
-                if (behavior == Particle::ALTERNATING) alternating_dir = !alternating_dir;
-                if (behavior == Particle::SPREAD) spread_angle_current = rotation_clamp(spread_angle_current+20, 0.0, 360.0);
+            spawn_count++;
+            if (behavior == Particle::ALTERNATING) alternating_dir = !alternating_dir;
+            if (behavior == Particle::SPREAD) spread_angle_current = rotation_clamp(spread_angle_current+20, 0.0, 360.0);
 
-                init_kin = get_initial_kinematics();
+            init_kin = get_initial_kinematics();
 
-                emission_angle = emission_vector.get_horizantal_angle() + spread_angle_current;
+            emission_angle = emission_vector.get_horizantal_angle() + spread_angle_current;
 
-                init_kin.position = init_kin.position.get_rotated(emission_angle, position);
-                init_kin.velocity = init_kin.velocity.get_rotated(emission_angle, position);
-                init_kin.acceleration = init_kin.acceleration.get_rotated(emission_angle, position);
+            init_kin.position = init_kin.position.get_rotated(emission_angle, position);
+            init_kin.velocity = init_kin.velocity.get_rotated(emission_angle, position);
+            init_kin.acceleration = init_kin.acceleration.get_rotated(emission_angle, position);
 
-                if (!alternating_dir) init_kin.position = init_kin.position.get_opposite();
-                if (!alternating_dir) init_kin.velocity = init_kin.velocity.get_opposite();
-                if (!alternating_dir) init_kin.acceleration = init_kin.acceleration.get_opposite();
-            }
-            
-            if (spawn_count == amount) break;
+            if (!alternating_dir) init_kin.position = init_kin.position.get_opposite();
+            if (!alternating_dir) init_kin.velocity = init_kin.velocity.get_opposite();
+            if (!alternating_dir) init_kin.acceleration = init_kin.acceleration.get_opposite();
         }
     }
 
-    ~ParticleEmitter() {
-        free(instances);
-    }
-
     protected:
 
     virtual void drawPoint() {
@@ -272,7 +542,11 @@ class AnimatedParticleEmitter {
 
     protected:
 
-    Instance* instances;
+    Particle::store particles;
+    //one clock read per update, shared by every particle
+    seconds_t last_update_time;
+    //whether the emitter is being driven with update(dt), in which case the clock isnt used at all
+    bool fixed_step = false;
     int MAX_PARTICLES;
     renderer* rend;
     dvec2 emission_vector;
@@ -286,14 +560,11 @@ class AnimatedParticleEmitter {
     public:
     AnimatedParticleEmitter(renderer& r, dvec2 position, int max_particles, emission_BEHAVIOR behavior = Particle::LINEAR) {
         MAX_PARTICLES = max_particles;
-        instances = (Instance*)malloc(sizeof(Instance) * max_particles);
+        particles.resize(max_particles);
+        last_update_time = getUTCTime();
         rend = &r;
         this->behavior = behavior;
 
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            instances[i] = Instance({0, 0}, {0, 0}, {0, 0}, 0.0);
-        }
-
         this->position = position;
     }
 
@@ -319,31 +590,44 @@ class AnimatedParticleEmitter {
 
 
     void draw() {
+        CELERIT_PROFILE_ZONE("particles::draw");
         dvec2 pos_offset = {0, 0};
         if (scroll != nullptr) {
             pos_offset = *scroll;
         }
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            if (instances[i].isAlive()) {
-                drawPoint(instances[i], instances[i].position, pos_offset);
-            }
+        for (int i = 0; i < particles.alive_count(); i++) {
+            drawPoint(particles.get_instance(i, last_update_time), particles.get_position(i), pos_offset);
         }
     }
 
     void update() {
         //updates all particles
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            instances[i].update();
-        }
+        CELERIT_PROFILE_ZONE("particles::update");
+        seconds_t now = getUTCTime();
+        particles.integrate(now - last_update_time);
+        last_update_time = now;
+        fixed_step = false;
     }
 
-    int get_alive_particles() {
-        int c = 0;
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            c += instances[i].isAlive();
-        }
+    void update(seconds_t dt) {
+        /*
+        updates all particles by a fixed amount of time, meant to be driven by a sim_clock
+        motion is scaled by dt against Particle::NOMINAL_RATE, so particles move the same as with update() but independent of the step rate
+        */
+        CELERIT_PROFILE_ZONE("particles::update");
+        particles.integrate(dt, static_cast<float>(dt * Particle::NOMINAL_RATE));
+        fixed_step = true;
+    }
 
-        return c;
+    void update(seconds_t dt, job_system& jobs) {
+        //the same as update(dt), with the particles split up across the job systems workers
+        CELERIT_PROFILE_ZONE("particles::update");
+        particles.integrate(jobs, dt, static_cast<float>(dt * Particle::NOMINAL_RATE));
+        fixed_step = true;
+    }
+
+    int get_alive_particles() {
+        return particles.alive_count();
     }
 
 
@@ -373,6 +657,8 @@ class AnimatedParticleEmitter {
     void spawn_particles(int amount) {
         //spawns **amount** particles so long as the number of alive particles plus amount is less than max particles
         int spawn_count = 0;
+        //particles spawned between updates shouldnt lose the time from before they existed on the next update
+        seconds_t life_span = fixed_step ? 10 : 10 + (getUTCTime() - last_update_time);
         kinematics init_kin = get_initial_kinematics();
         arcdegrees emission_angle = emission_vector.get_horizantal_angle() + spread_angle_current;
 
@@ -384,36 +670,27 @@ class AnimatedParticleEmitter {
         if (!alternating_dir) init_kin.velocity = init_kin.velocity.get_opposite();
         if (!alternating_dir) init_kin.acceleration = init_kin.acceleration.get_opposite();
 
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            if (!instances[i].isAlive()) {
-                instances[i] = Instance(init_kin.position, init_kin.velocity, init_kin.acceleration, 
-                10, false);
+        while (spawn_count < amount) {
+            if (particles.spawn(init_kin, life_span, false) == -1) break;
 
-                spawn_count++;
-                if (behavior == Particle::ALTERNATING) alternating_dir = !alternating_dir;
-                if (behavior == Particle::SPREAD) spread_angle_current = rotation_clamp(spread_angle_current+20, 0.0, 360.0);
+            spawn_count++;
+            if (behavior == Particle::ALTERNATING) alternating_dir = !alternating_dir;
+            if (behavior == Particle::SPREAD) spread_angle_current = rotation_clamp(spread_angle_current+20, 0.0, 360.0);
 
-                init_kin = get_initial_kinematics();
+            init_kin = get_initial_kinematics();
 
-                emission_angle = emission_vector.get_horizantal_angle() + spread_angle_current;
+            emission_angle = emission_vector.get_horizantal_angle() + spread_angle_current;
 
-                init_kin.position = init_kin.position.get_rotated(emission_angle, position);
-                init_kin.velocity = init_kin.velocity.get_rotated(emission_angle, position);
-                init_kin.acceleration = init_kin.acceleration.get_rotated(emission_angle, position);
+            init_kin.position = init_kin.position.get_rotated(emission_angle, position);
+            init_kin.velocity = init_kin.velocity.get_rotated(emission_angle, position);
+            init_kin.acceleration = init_kin.acceleration.get_rotated(emission_angle, position);
 
-                if (!alternating_dir) init_kin.position = init_kin.position.get_opposite();
-                if (!alternating_dir) init_kin.velocity = init_kin.velocity.get_opposite();
-                if (!alternating_dir) init_kin.acceleration = init_kin.acceleration.get_opposite();
-            }
-            
-            if (spawn_count == amount) break;
+            if (!alternating_dir) init_kin.position = init_kin.position.get_opposite();
+            if (!alternating_dir) init_kin.velocity = init_kin.velocity.get_opposite();
+            if (!alternating_dir) init_kin.acceleration = init_kin.acceleration.get_opposite();
         }
     }
 
-    ~AnimatedParticleEmitter() {
-        free(instances);
-    }
-
     protected:
 
     virtual void drawPoint(Instance i, dvec2 pos, dvec2 scroll) {
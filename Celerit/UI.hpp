@@ -8,9 +8,28 @@
 
 #include "renderer.hpp"
 #include "CeleritObject.hpp"
+#include "aabb_tree.hpp"
+#include "render_snapshot.hpp"
+#include <deque>
 
 
 
+class CUIElement;
+
+//one quad of what a UI element draws, already in screen space, see CUIElement::build_draw_list
+struct ui_draw_cmd {
+    //nullptr for a plain rect filled with tint
+    texture* tex;
+    rect source;
+    rect dest;
+    double angle;
+    dvec2 center;
+    color tint;
+    //set for elements that cant describe themselves as quads, they are drawn by calling their draw function instead
+    CUIElement* immediate = nullptr;
+};
+
+
 /*
 A base class for all UI elements, contains functions for transform aswell as interface functions
 */
@@ -20,6 +39,36 @@ class CUIElement : public CObject {
     double rotation_angle = 0.0;
     dvec2 scr_pos = {0, 0};
     dvec2 relative_center = {0, 0};
+    //set whenever the element changes how it looks, so a ui_compositor knows to redraw it
+    bool dirty = true;
+    //bumped along with dirty, so caches (like a canvas' draw list) can notice changes without clearing the flag
+    unsigned int revision = 0;
+    //the draw list built by draw_retained, kept per element so drawing one element from inside another doesnt clobber it
+    std::vector<ui_draw_cmd> retained_cmds;
+
+    static rect rotated_bounds(rect dest, dvec2 center, arcdegrees angle) {
+        //the screen area a rect covers once SDL has rotated it around center (relative to the rects corner)
+        if (angle == 0.0) return dest;
+        double rad = angle * RADIAN_CONVERSION;
+        double c = std::cos(rad);
+        double s = std::sin(rad);
+        double min_x = DBL_MAX, min_y = DBL_MAX, max_x = -DBL_MAX, max_y = -DBL_MAX;
+        dvec2 corners[4] = {{0, 0}, {(double)dest.w, 0}, {(double)dest.w, (double)dest.h}, {0, (double)dest.h}};
+        for (dvec2 corner: corners) {
+            double x = corner.x - center.x;
+            double y = corner.y - center.y;
+            double rx = dest.x + center.x + x * c - y * s;
+            double ry = dest.y + center.y + x * s + y * c;
+            min_x = std::min(min_x, rx);
+            min_y = std::min(min_y, ry);
+            max_x = std::max(max_x, rx);
+            max_y = std::max(max_y, ry);
+        }
+        //a pixel of slack on each side for rounding and filtering
+        int x1 = (int)std::floor(min_x) - 1;
+        int y1 = (int)std::floor(min_y) - 1;
+        return rect{{x1, y1, (int)std::ceil(max_x) + 1 - x1, (int)std::ceil(max_y) + 1 - y1}};
+    }
 
     public:
     
@@ -27,7 +76,97 @@ class CUIElement : public CObject {
         obj_name = "CUIElement";
     }
 
+    static void submit_draw_list(renderer& r, const std::vector<ui_draw_cmd>& cmds) {
+        //queues a draw list as one batch, which is flushed right away unless the renderer is batching anyway
+        for (const ui_draw_cmd& cmd: cmds) {
+            if (cmd.immediate != nullptr) {
+                r.flush_batch();
+                cmd.immediate->draw();
+            } else if (cmd.tex != nullptr) {
+                r.queue_texture(*cmd.tex, cmd.source, cmd.dest, cmd.angle, cmd.center, SDL_FLIP_NONE, cmd.tint);
+            } else {
+                r.queue_rect(cmd.dest, cmd.tint);
+            }
+        }
+        if (!r.get_batching()) r.flush_batch();
+    }
+
+    void draw_retained(renderer& r) {
+        //draws the element through its own draw list, for elements that implement CUIElement::build_draw_list
+        retained_cmds.clear();
+        build_draw_list(retained_cmds);
+        submit_draw_list(r, retained_cmds);
+    }
+
+    bool capture(render_snapshot& snap) {
+        /*
+        adds the element to a snapshot through its draw list, see frame_pipeline
+        elements (or canvas children) that can only draw themselves immediately are left out, and false is returned
+        a canvas rebuilds its cached draw list here, so nothing else may use the element while it is being captured
+        */
+        static thread_local std::vector<ui_draw_cmd> scratch;
+        scratch.clear();
+        if (!build_draw_list(scratch)) return false;
+        bool complete = true;
+        for (ui_draw_cmd& cmd: scratch) {
+            if (cmd.immediate != nullptr) {
+                complete = false;
+            } else if (cmd.tex != nullptr) {
+                snap.add(*cmd.tex, cmd.source, cmd.dest, cmd.angle, cmd.center, cmd.tint);
+            } else {
+                snap.add_rect(cmd.dest, cmd.tint);
+            }
+        }
+        return complete;
+    }
+
+    void mark_dirty() {
+        //call from subclasses whenever something that changes how the element looks changes
+        dirty = true;
+        revision++;
+    }
+
+    virtual unsigned int get_revision() {
+        return revision;
+    }
+
+    virtual bool build_draw_list(std::vector<ui_draw_cmd>&) {
+        //appends the quads the element draws (in screen space) to out, returns false if the element cant be drawn that way
+        return false;
+    }
+
+    virtual bool is_dirty() {
+        return dirty;
+    }
+
+    virtual void clear_dirty() {
+        dirty = false;
+    }
+
+    static rect unbounded() {
+        //the bounds of an element that doesnt say where it draws, big enough to cover any screen
+        return rect{{-(1 << 28), -(1 << 28), 1 << 29, 1 << 29}};
+    }
+
+    virtual rect get_bounds() {
+        //the screen area the element draws over, elements that dont override this are treated as covering everything
+        return unbounded();
+    }
+
+    virtual bool hit_test(dvec2 point) {
+        /*
+        whether the point is on the element, by default anywhere in its bounds
+        an element without bounds of its own cant be hit unless it overrides this, otherwise it would be hit everywhere
+        and hide every element under it
+        */
+        rect b = get_bounds();
+        rect all = unbounded();
+        if (b.x == all.x && b.y == all.y && b.w == all.w && b.h == all.h) return false;
+        return point.x >= b.x && point.y >= b.y && point.x < b.x + b.w && point.y < b.y + b.h;
+    }
+
     virtual void scale(double scalar) {
+        mark_dirty();
         scaling.x *= scalar;
         scaling.y *= scalar;
 
@@ -36,6 +175,7 @@ class CUIElement : public CObject {
     }
 
     virtual void scale(dvec2 scalar) {
+        mark_dirty();
         scaling.x *= scalar.x;
         scaling.y *= scalar.y;
 
@@ -44,7 +184,7 @@ class CUIElement : public CObject {
     }
 
     virtual void set_scale(dvec2 scale) {
-        
+        mark_dirty();
         relative_center.x *= scale.x / scaling.x;
         relative_center.y *= scale.y / scaling.y;
         
@@ -55,23 +195,26 @@ class CUIElement : public CObject {
 
 
     virtual void set_pos(dvec2 vec) {
-
+        mark_dirty();
         relative_center += (vec - scr_pos);
 
         scr_pos = vec;
     }
 
     virtual void move(dvec2 movement) {
+        mark_dirty();
         relative_center += movement;
         scr_pos += movement;
     }
 
     virtual void rotate(arcdegrees angle) {
+        mark_dirty();
         rotation_angle += angle;
         rotation_angle = rotation_clamp(rotation_angle, 0.0, 360.0);
     }
 
     virtual void set_rotation(arcdegrees angle) {
+        mark_dirty();
         rotation_angle = angle;
         rotation_angle = rotation_clamp(rotation_angle, 0.0, 360.0);
     }
@@ -83,6 +226,7 @@ class CUIElement : public CObject {
     virtual void draw() {};
 
     virtual void set_relative_center(dvec2 new_center) {
+        mark_dirty();
         relative_center = new_center;
     };
 };
@@ -212,16 +356,19 @@ class progress_bar : public CUIElement {
 
     void set_overlay_mode(bool b) {
         overlay_mode = true;
+        mark_dirty();
     }
 
     void increase_percent(float amount) {
         //amount should be between 0-1
         amount = clamp(amount, -1.0F, 1.0F);
-        progress = clamp(progress+amount, 0.0F, 1.0F);
+        set_percent(progress+amount);
     }
 
     void set_percent(float x) {
-        progress = clamp(x, 0.0F, 1.0F);
+        x = clamp(x, 0.0F, 1.0F);
+        if (x != progress) mark_dirty();
+        progress = x;
     }
 
     float get_percent() {
@@ -240,11 +387,15 @@ class progress_bar : public CUIElement {
         self_rect.y = vec.y;
     }
 
-    void draw() override {
-        
-            
-        rend->blit_texture(empty, {self_rect.x, self_rect.y, static_cast<int>(self_rect.w * scaling.x), static_cast<int>(self_rect.h*scaling.y)},
-        rotation_angle, ivec2{static_cast<int>((self_rect.w*scaling.x)/2), static_cast<int>((self_rect.h*scaling.y)/2)}.convert_data<double>());
+    rect get_bounds() override {
+        rect dest = {self_rect.x, self_rect.y, static_cast<int>(self_rect.w * scaling.x), static_cast<int>(self_rect.h*scaling.y)};
+        return rotated_bounds(dest, ivec2{static_cast<int>((self_rect.w*scaling.x)/2), static_cast<int>((self_rect.h*scaling.y)/2)}.convert_data<double>(), rotation_angle);
+    }
+
+    bool build_draw_list(std::vector<ui_draw_cmd>& out) override {
+        dvec2 center = ivec2{static_cast<int>((self_rect.w*scaling.x)/2), static_cast<int>((self_rect.h*scaling.y)/2)}.convert_data<double>();
+        out.push_back({&empty, empty.get_rect(), rect{self_rect.x, self_rect.y, static_cast<int>(self_rect.w * scaling.x), static_cast<int>(self_rect.h*scaling.y)},
+        rotation_angle, center, WHITE});
         
         rect filled_rect = filled.get_rect();
         if (!overlay_mode) {
@@ -253,11 +404,14 @@ class progress_bar : public CUIElement {
         } else {
             filled_rect.w = (filled_rect.w*progress);
         }
-        rend->blit_texture(filled, filled_rect, {self_rect.x, self_rect.y, static_cast<int>(filled_rect.w*scaling.x), 
+        out.push_back({&filled, filled_rect, rect{self_rect.x, self_rect.y, static_cast<int>(filled_rect.w*scaling.x), 
         static_cast<int>(scaling.y*filled_rect.h)}, 
-        rotation_angle, ivec2{static_cast<int>((self_rect.w*scaling.x)/2), static_cast<int>((self_rect.h*scaling.y)/2)}.convert_data<double>());
+        rotation_angle, center, WHITE});
+        return true;
+    }
 
-        
+    void draw() override {
+        draw_retained(*rend);
     }
 };
 
@@ -271,13 +425,16 @@ class image : public CUIElement {
     protected:
     renderer* r;
     texture t;
+    //set when the image was loaded from a file, keeps the cached texture alive
+    renderer::texture_handle t_handle;
 
     public:
     
     image(renderer& rend, string texture_file, dvec2 scrpos) : CUIElement() {
         r = &rend;
         this->scr_pos = scrpos;
-        t = texture(rend, texture_file);
+        t_handle = rend.load_texture(texture_file);
+        t = t_handle;
     }
 
     image(renderer& rend, texture& text, dvec2 scrpos) : CUIElement() {
@@ -286,10 +443,21 @@ class image : public CUIElement {
         t = text;
     }
 
-    void draw() override {
-        r->blit_texture(t, {static_cast<int>(scr_pos.x), static_cast<int>(scr_pos.y), 
+    rect get_bounds() override {
+        rect dest = {static_cast<int>(scr_pos.x), static_cast<int>(scr_pos.y), 
+        static_cast<int>(scaling.x*t.get_rect().w), static_cast<int>(scaling.y*t.get_rect().h)};
+        return rotated_bounds(dest, {(scaling.x*t.get_rect().w)/2.0, (scaling.y*t.get_rect().h)/2.0}, rotation_angle);
+    }
+
+    bool build_draw_list(std::vector<ui_draw_cmd>& out) override {
+        out.push_back({&t, t.get_rect(), rect{static_cast<int>(scr_pos.x), static_cast<int>(scr_pos.y), 
         static_cast<int>(scaling.x*t.get_rect().w), static_cast<int>(scaling.y*t.get_rect().h)}, rotation_angle,
-        {(scaling.x*t.get_rect().w)/2.0, (scaling.y*t.get_rect().h)/2.0});
+        {(scaling.x*t.get_rect().w)/2.0, (scaling.y*t.get_rect().h)/2.0}, WHITE});
+        return true;
+    }
+
+    void draw() override {
+        draw_retained(*r);
     }
 };
 
@@ -366,13 +534,9 @@ class button : public CUIElement {
     
 
     bool is_clicked(input& i) {
-        if (i.get_mouse().left && button_quad.is_in(i.get_mouse_pos().convert_data<double>())) {
-            is_pressed = true;
-            return true;
-        } else {
-            is_pressed = false;
-            return false;
-        }
+        bool clicked = i.get_mouse().left && button_quad.is_in(i.get_mouse_pos().convert_data<double>());
+        update(clicked);
+        return clicked;
     }
 
     
@@ -380,13 +544,14 @@ class button : public CUIElement {
         //returns whether the buttons state has changed or not
         if (is_being_pressed != is_pressed) {
             is_pressed = is_being_pressed;
+            mark_dirty();
             return true;
         }
         return false;
     }
 
     void press() {
-        is_pressed = true;
+        update(true);
     }
 
 
@@ -438,11 +603,13 @@ class button : public CUIElement {
     }
 
     void rotate(arcdegrees angle) override {
+        mark_dirty();
         rotation_angle += angle;
         button_quad.rotate(angle);
     }
 
     void set_rotation(arcdegrees angle) override {
+        mark_dirty();
         button_quad.rotate(angle - rotation_angle);
         
         rotation_angle = angle;
@@ -453,42 +620,127 @@ class button : public CUIElement {
         return button_quad;
     }
 
-    void draw() override {
+    bool hit_test(dvec2 point) override {
+        return button_quad.is_in(point);
+    }
+
+    rect get_bounds() override {
+        //the outline is drawn unrotated, so it is covered aswell as the rotated texture
+        rect r = rect{static_cast<int>(scr_pos.x), static_cast<int>(scr_pos.y), static_cast<int>(unrotated.w*scaling.x), 
+            static_cast<int>(unrotated.h*scaling.y)};
+        return union_rect(r, rotated_bounds(r, relative_center, rotation_angle));
+    }
+
+    bool build_draw_list(std::vector<ui_draw_cmd>& out) override {
         rect r = rect{static_cast<int>(scr_pos.x), static_cast<int>(scr_pos.y), static_cast<int>(unrotated.w*scaling.x), 
             static_cast<int>(unrotated.h*scaling.y)};
         
-        if (is_pressed) {
-            rend->blit_texture(pressed_texture, r, 
-            rotation_angle, relative_center);
-        } else {
-            rend->blit_texture(unpressed_texture, r, rotation_angle, relative_center);
+        texture& t = is_pressed ? pressed_texture : unpressed_texture;
+        out.push_back({&t, t.get_rect(), r, rotation_angle, relative_center, WHITE});
+
+        //the one pixel outline, as four thin rects, fewer when the button is too thin for the edges to be separate
+        if (r.w <= 0 || r.h <= 0) return true;
+        out.push_back({nullptr, {0, 0, 0, 0}, rect{r.x, r.y, r.w, 1}, 0.0, {0, 0}, WHITE});
+        if (r.h > 1) out.push_back({nullptr, {0, 0, 0, 0}, rect{r.x, r.y + r.h - 1, r.w, 1}, 0.0, {0, 0}, WHITE});
+        if (r.h > 2) {
+            out.push_back({nullptr, {0, 0, 0, 0}, rect{r.x, r.y + 1, 1, r.h - 2}, 0.0, {0, 0}, WHITE});
+            if (r.w > 1) out.push_back({nullptr, {0, 0, 0, 0}, rect{r.x + r.w - 1, r.y + 1, 1, r.h - 2}, 0.0, {0, 0}, WHITE});
         }
-        rend->draw_rect(r, WHITE, 1);
+        return true;
+    }
+
+    void draw() override {
+        draw_retained(*rend);
     }
 };
 
 
 class canvas : public CUIElement {
     std::vector<CUIElement*> elements;
+    //the flattened draw list of every element, only rebuilt when an element (or the canvas itself) has changed
+    renderer* rend = nullptr;
+    std::vector<ui_draw_cmd> draw_list;
+    std::vector<unsigned int> list_revisions;
+
+    //hit testing index over the elements bounds, entries line up with elements and are refreshed lazily by revision
+    //a deque so the bounds dont move when elements are added, the tree points at them
+    struct hit_entry {
+        rect bounds;
+        int proxy;
+        unsigned int revision;
+    };
+    aabb_tree hit_tree;
+    std::deque<hit_entry> hit_entries;
+
+    void refresh_hit_index() {
+        //adds new elements to the tree and moves the ones that changed
+        while (hit_entries.size() < elements.size()) {
+            CUIElement* elm = elements[hit_entries.size()];
+            hit_entries.push_back({elm->get_bounds(), -1, elm->get_revision()});
+            hit_entry& e = hit_entries.back();
+            e.proxy = hit_tree.insert(&e.bounds, reinterpret_cast<void*>(static_cast<intptr_t>(hit_entries.size() - 1)));
+        }
+        for (size_t i = 0; i < elements.size(); i++) {
+            unsigned int rev = elements[i]->get_revision();
+            if (rev == hit_entries[i].revision) continue;
+            hit_entries[i].revision = rev;
+            hit_entries[i].bounds = elements[i]->get_bounds();
+            hit_tree.update(hit_entries[i].proxy);
+        }
+    }
+
+    bool draw_list_current() {
+        //checks every elements revision against the one the draw list was built from
+        if (list_revisions.size() != elements.size()) return false;
+        for (size_t i = 0; i < elements.size(); i++) {
+            if (elements[i]->get_revision() != list_revisions[i]) return false;
+        }
+        return true;
+    }
+
+    void rebuild_draw_list() {
+        draw_list.clear();
+        list_revisions.clear();
+        for (CUIElement* elm: elements) {
+            list_revisions.push_back(elm->get_revision());
+            if (!elm->build_draw_list(draw_list)) {
+                draw_list.push_back({nullptr, {0, 0, 0, 0}, {0, 0, 0, 0}, 0.0, {0, 0}, WHITE, elm});
+            }
+        }
+    }
 
     public:
     canvas(dvec2 pos) : CUIElement() {
+        //a canvas without a renderer draws its elements one by one, it cant submit them as a batch
         obj_name = "Canvas";
         scr_pos = pos;
     }
 
+    canvas(renderer& r, dvec2 pos) : CUIElement() {
+        //a canvas that keeps a draw list of its elements and submits it to <r> as one batch
+        obj_name = "Canvas";
+        scr_pos = pos;
+        rend = &r;
+    }
+
+    canvas(canvas&& other) : CUIElement(other) {
+        //takes over the others elements, the draw list and hit index are rebuilt from them the next time theyre needed
+        obj_name = other.obj_name;
+        rend = other.rend;
+        elements = std::move(other.elements);
+        other.elements.clear();
+    }
+
+    //the elements are owned, so a canvas can only be moved
+    canvas(const canvas&) = delete;
+    canvas& operator=(const canvas&) = delete;
+
 
     template<typename T, typename = std::enable_if_t<std::is_base_of_v<CUIElement, T>>>
     T* create_UI_element(T instance) {
         
-        T* UIobj = (T*)malloc(sizeof(T));
-        memcpy(UIobj, &instance, sizeof(T));
-        
-        
-        if (UIobj == nullptr) {
-            cerr << "Error creating UI object!";
-            exit(-1);
-        }
+        //moved rather than copied bytewise, so members like strings and texture handles stay valid
+        T* UIobj = new T(std::move(instance));
 
 
         elements.push_back(UIobj);
@@ -517,7 +769,7 @@ class canvas : public CUIElement {
     void set_scale(dvec2 scale) override {
 
         for (CUIElement* elm: elements) {
-            elm->scale(scaling - scale);
+            elm->scale(dvec2{scale.x / scaling.x, scale.y / scaling.y});
         }
 
         CUIElement::set_scale(scale);
@@ -550,26 +802,223 @@ class canvas : public CUIElement {
         for (CUIElement* elm: elements) {
             elm->rotate(angle - rotation_angle);
         }
-        CUIElement::rotate(angle);
+        CUIElement::set_rotation(angle);
     }
     
 
 
-    void draw() override {
+    unsigned int get_revision() override {
+        //changes whenever any element changes, so a canvas inside another canvas invalidates its parents draw list
+        unsigned int total = revision;
+        for (CUIElement* elm: elements) {
+            total += elm->get_revision();
+        }
+        return total;
+    }
+
+    CUIElement* element_at(dvec2 point, bool descend = true) {
+        /*
+        returns the topmost element under the point (the one added last), or nullptr if there isnt one
+        if that element is a canvas and descend is set, the topmost element inside it is returned instead
+        */
+        refresh_hit_index();
+        int top = -1;
+        rect probe = {static_cast<int>(std::floor(point.x)), static_cast<int>(std::floor(point.y)), 0, 0};
+        hit_tree.query(probe, [&](rect*, void* user) {
+            int i = static_cast<int>(reinterpret_cast<intptr_t>(user));
+            if (i > top && elements[i]->hit_test(point)) top = i;
+            return false;
+        });
+        if (top < 0) return nullptr;
+
+        CUIElement* hit = elements[top];
+        if (descend) {
+            if (canvas* inner = dynamic_cast<canvas*>(hit)) return inner->element_at(point, true);
+        }
+        return hit;
+    }
+
+    bool hit_test(dvec2 point) override {
+        return element_at(point, false) != nullptr;
+    }
+
+    bool build_draw_list(std::vector<ui_draw_cmd>& out) override {
+        if (!draw_list_current()) rebuild_draw_list();
+        out.insert(out.end(), draw_list.begin(), draw_list.end());
+        return true;
+    }
+
+    bool is_dirty() override {
+        if (dirty) return true;
         for (CUIElement* elm: elements) {
-            elm->draw();
+            if (elm->is_dirty()) return true;
         }
+        return false;
+    }
+
+    void clear_dirty() override {
+        CUIElement::clear_dirty();
+        for (CUIElement* elm: elements) {
+            elm->clear_dirty();
+        }
+    }
+
+    rect get_bounds() override {
+        //everything the canvas' elements cover
+        rect bounds = {0, 0, 0, 0};
+        for (CUIElement* elm: elements) {
+            bounds = union_rect(bounds, elm->get_bounds());
+        }
+        return bounds;
+    }
+
+    void draw() override {
+        CELERIT_PROFILE_ZONE("canvas::draw");
+        if (rend == nullptr) {
+            for (CUIElement* elm: elements) {
+                elm->draw();
+            }
+            return;
+        }
+        if (!draw_list_current()) rebuild_draw_list();
+        submit_draw_list(*rend, draw_list);
+    }
+
+    int get_draw_list_size() {
+        //the number of quads in the retained draw list, as of the last draw
+        return (int)draw_list.size();
     }
 
 
 
     ~canvas() {
         for (CUIElement* elem: elements) {
-            free(elem);
+            delete elem;
         }
     }
 
 };
 
 
+
+/*
+Partial redraw for screens that are mostly UI, elements are drawn to a texture that is kept between frames
+and only the area covered by elements that changed (and where they were before) is drawn again
+
+    ui_compositor ui(rend, BLACK);
+    ui.add(&menu_canvas);
+    //every frame:
+    if (ui.redraw()) {
+        ui.draw();
+        rend.update();
+    }
+
+when ui_compositor::redraw returns false nothing changed, so presenting can be skipped entirely
+elements have to be drawn in the order they were added, so overlapping elements keep their layering
+*/
+class ui_compositor {
+    private:
+    struct tracked {
+        CUIElement* elm;
+        //the area the element covered the last time it was drawn
+        rect last_bounds;
+    };
+
+    renderer* rend;
+    texture target;
+    color background;
+    std::vector<tracked> elements;
+    //area that has to be redrawn no matter what, such as where a removed element was
+    rect damage = {0, 0, 0, 0};
+    bool full_redraw = true;
+    rect last_redraw = {0, 0, 0, 0};
+
+    public:
+
+    ui_compositor(renderer& r, color background = {0, 0, 0, 0}) : target(r, r.get_screen_rect().w, r.get_screen_rect().h) {
+        //creates a compositor covering the whole screen, redrawn areas are cleared to <background> first
+        rend = &r;
+        this->background = background;
+    }
+
+    ui_compositor(const ui_compositor&) = delete;
+    ui_compositor& operator=(const ui_compositor&) = delete;
+
+    void add(CUIElement* e) {
+        //starts compositing an element, it is drawn above everything added before it
+        elements.push_back({e, e->get_bounds()});
+        e->mark_dirty();
+    }
+
+    void remove(CUIElement* e) {
+        for (size_t i = 0; i < elements.size(); i++) {
+            if (elements[i].elm == e) {
+                damage = union_rect(damage, elements[i].last_bounds);
+                elements.erase(elements.begin() + i);
+                return;
+            }
+        }
+    }
+
+    void invalidate() {
+        //redraws everything next time, for when something the compositor cant see changed (such as the background color)
+        full_redraw = true;
+    }
+
+    void set_background(color c) {
+        background = c;
+        full_redraw = true;
+    }
+
+    bool redraw() {
+        //redraws whatever changed into the composited texture, returns whether anything was redrawn
+        CELERIT_PROFILE_ZONE("ui_compositor::redraw");
+        rect area = damage;
+        for (tracked& t: elements) {
+            if (!t.elm->is_dirty()) continue;
+            rect now = t.elm->get_bounds();
+            area = union_rect(area, union_rect(t.last_bounds, now));
+            t.last_bounds = now;
+        }
+        rect whole = {0, 0, target.get_pixel_size().x, target.get_pixel_size().y};
+        if (full_redraw) area = whole;
+        area = intersect_rect(area, whole);
+
+        damage = {0, 0, 0, 0};
+        full_redraw = false;
+        last_redraw = area;
+        for (tracked& t: elements) t.elm->clear_dirty();
+        if (rect_empty(area)) return false;
+
+        renderer::target_state previous = rend->save_target();
+        rend->set_render_target(target);
+        rend->set_clip_rect(area);
+        rend->clear_rect(area, background);
+        for (tracked& t: elements) {
+            if (collide_rect(t.last_bounds, area)) t.elm->draw();
+        }
+        rend->restore_target(previous);
+        return true;
+    }
+
+    void draw() {
+        //draws the composited UI to the current target
+        rend->blit_texture(target, 0, 0);
+    }
+
+    rect get_last_redraw_rect() {
+        //the area the last ui_compositor::redraw drew, empty if nothing changed
+        return last_redraw;
+    }
+
+    texture& get_texture() {
+        return target;
+    }
+
+    ~ui_compositor() {
+        rend->destroy_texture(target);
+    }
+};
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,393 @@
+#ifndef AABB_TREE
+#define AABB_TREE
+
+#include "util.hpp"
+#include <algorithm>
+#include <vector>
+
+
+//an axis aligned bounding box in floats, used internally by the aabb_tree
+struct aabb {
+    float min_x;
+    float min_y;
+    float max_x;
+    float max_y;
+
+    static aabb from_rect(const rect& r, float margin = 0.0f) {
+        //makes a box from a rect, grown on every side by margin
+        return {r.x - margin, r.y - margin, r.x + r.w + margin, r.y + r.h + margin};
+    }
+
+    static aabb merge(const aabb& a, const aabb& b) {
+        //returns the smallest box that contains both boxes
+        return {std::min(a.min_x, b.min_x), std::min(a.min_y, b.min_y), std::max(a.max_x, b.max_x), std::max(a.max_y, b.max_y)};
+    }
+
+    float perimeter() const {
+        return 2.0f * ((max_x - min_x) + (max_y - min_y));
+    }
+
+    bool contains(const aabb& other) const {
+        return min_x <= other.min_x && min_y <= other.min_y && max_x >= other.max_x && max_y >= other.max_y;
+    }
+
+    bool overlaps(const aabb& other) const {
+        //touching counts, same as collide_rect
+        return !(max_x < other.min_x || other.max_x < min_x || max_y < other.min_y || other.max_y < min_y);
+    }
+};
+
+
+//two colliders whose rects collide, along with whatever user data they were registered with
+struct aabb_pair {
+    rect* a;
+    rect* b;
+    void* user_a;
+    void* user_b;
+};
+
+
+/*
+A dynamic AABB tree (a bounding volume hierarchy that can change every frame) for lots of moving colliders
+every rect gets a leaf with a "fat" box, the rect grown by a margin, so small movements dont touch the tree at all
+when a rect leaves its fat box its leaf is taken out and put back in, and the tree is kept balanced with rotations
+
+use it for queries (aabb_tree::query) or to find every overlapping pair at once (aabb_tree::find_pairs)
+rects are stored as pointers, call aabb_tree::update after moving a rect
+*/
+class aabb_tree {
+    private:
+    struct node {
+        aabb box;
+        int parent;
+        int left;
+        int right;
+        //0 for leaves, -1 for nodes on the free list
+        int height;
+        //the next free node while on the free list
+        int next;
+        rect* r;
+        void* user;
+    };
+
+    std::vector<node> nodes;
+    int root = -1;
+    int free_list = -1;
+    int proxy_count = 0;
+    float margin;
+
+
+    int allocate_node() {
+        //grabs a node off the free list, or makes a new one
+        if (free_list == -1) {
+            nodes.push_back({});
+            nodes.back().next = -1;
+            free_list = static_cast<int>(nodes.size()) - 1;
+        }
+        int id = free_list;
+        free_list = nodes[id].next;
+        nodes[id].parent = -1;
+        nodes[id].left = -1;
+        nodes[id].right = -1;
+        nodes[id].height = 0;
+        nodes[id].r = nullptr;
+        nodes[id].user = nullptr;
+        return id;
+    }
+
+    void free_node(int id) {
+        nodes[id].next = free_list;
+        nodes[id].height = -1;
+        free_list = id;
+    }
+
+    bool is_leaf(int id) const {
+        return nodes[id].left == -1;
+    }
+
+    void refit_upwards(int index) {
+        //walks from index up to the root, rebalancing and fixing the boxes and heights along the way
+        while (index != -1) {
+            index = balance(index);
+            node& n = nodes[index];
+            n.height = 1 + std::max(nodes[n.left].height, nodes[n.right].height);
+            n.box = aabb::merge(nodes[n.left].box, nodes[n.right].box);
+            index = n.parent;
+        }
+    }
+
+    void insert_leaf(int leaf) {
+        if (root == -1) {
+            root = leaf;
+            nodes[root].parent = -1;
+            return;
+        }
+
+        //walk down to the best sibling, going whichever way grows the tree the least (by perimeter)
+        aabb leaf_box = nodes[leaf].box;
+        int index = root;
+        while (!is_leaf(index)) {
+            int left = nodes[index].left;
+            int right = nodes[index].right;
+
+            float area = nodes[index].box.perimeter();
+            float combined_area = aabb::merge(nodes[index].box, leaf_box).perimeter();
+
+            //the cost of making a new parent for this node and the leaf
+            float cost = 2.0f * combined_area;
+            //the cost of pushing the leaf further down, every ancestor grows
+            float inheritance_cost = 2.0f * (combined_area - area);
+
+            float cost_left = aabb::merge(leaf_box, nodes[left].box).perimeter() + inheritance_cost;
+            if (!is_leaf(left)) cost_left -= nodes[left].box.perimeter();
+            float cost_right = aabb::merge(leaf_box, nodes[right].box).perimeter() + inheritance_cost;
+            if (!is_leaf(right)) cost_right -= nodes[right].box.perimeter();
+
+            if (cost < cost_left && cost < cost_right) break;
+            index = cost_left < cost_right ? left : right;
+        }
+
+        int sibling = index;
+        int old_parent = nodes[sibling].parent;
+        int new_parent = allocate_node();
+        nodes[new_parent].parent = old_parent;
+        nodes[new_parent].box = aabb::merge(leaf_box, nodes[sibling].box);
+        nodes[new_parent].height = nodes[sibling].height + 1;
+        nodes[new_parent].left = sibling;
+        nodes[new_parent].right = leaf;
+        nodes[sibling].parent = new_parent;
+        nodes[leaf].parent = new_parent;
+
+        if (old_parent != -1) {
+            if (nodes[old_parent].left == sibling) {
+                nodes[old_parent].left = new_parent;
+            } else {
+                nodes[old_parent].right = new_parent;
+            }
+        } else {
+            root = new_parent;
+        }
+
+        refit_upwards(nodes[leaf].parent);
+    }
+
+    void remove_leaf(int leaf) {
+        if (leaf == root) {
+            root = -1;
+            return;
+        }
+
+        //the leafs parent goes away and the sibling takes its place
+        int parent = nodes[leaf].parent;
+        int grand_parent = nodes[parent].parent;
+        int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        if (grand_parent != -1) {
+            if (nodes[grand_parent].left == parent) {
+                nodes[grand_parent].left = sibling;
+            } else {
+                nodes[grand_parent].right = sibling;
+            }
+            nodes[sibling].parent = grand_parent;
+            free_node(parent);
+            refit_upwards(grand_parent);
+        } else {
+            root = sibling;
+            nodes[sibling].parent = -1;
+            free_node(parent);
+        }
+    }
+
+    int balance(int a) {
+        /*
+        if one side of a is 2 or more taller than the other, the taller child is rotated up into as place
+        returns the index of whatever node ended up where a was
+        */
+        if (is_leaf(a) || nodes[a].height < 2) return a;
+
+        int b = nodes[a].left;
+        int c = nodes[a].right;
+        int diff = nodes[c].height - nodes[b].height;
+
+        if (diff > 1) {
+            //rotate c up
+            int f = nodes[c].left;
+            int g = nodes[c].right;
+
+            nodes[c].left = a;
+            nodes[c].parent = nodes[a].parent;
+            nodes[a].parent = c;
+            replace_child(nodes[c].parent, a, c);
+
+            //the taller of cs children stays with c, the other goes to a
+            if (nodes[f].height > nodes[g].height) std::swap(f, g);
+            nodes[c].right = g;
+            nodes[a].right = f;
+            nodes[f].parent = a;
+
+            nodes[a].box = aabb::merge(nodes[b].box, nodes[f].box);
+            nodes[c].box = aabb::merge(nodes[a].box, nodes[g].box);
+            nodes[a].height = 1 + std::max(nodes[b].height, nodes[f].height);
+            nodes[c].height = 1 + std::max(nodes[a].height, nodes[g].height);
+            return c;
+        }
+
+        if (diff < -1) {
+            //rotate b up
+            int d = nodes[b].left;
+            int e = nodes[b].right;
+
+            nodes[b].left = a;
+            nodes[b].parent = nodes[a].parent;
+            nodes[a].parent = b;
+            replace_child(nodes[b].parent, a, b);
+
+            //the taller of bs children stays with b, the other goes to a
+            if (nodes[d].height > nodes[e].height) std::swap(d, e);
+            nodes[b].right = e;
+            nodes[a].left = d;
+            nodes[d].parent = a;
+
+            nodes[a].box = aabb::merge(nodes[c].box, nodes[d].box);
+            nodes[b].box = aabb::merge(nodes[a].box, nodes[e].box);
+            nodes[a].height = 1 + std::max(nodes[c].height, nodes[d].height);
+            nodes[b].height = 1 + std::max(nodes[a].height, nodes[e].height);
+            return b;
+        }
+
+        return a;
+    }
+
+    void replace_child(int parent, int old_child, int new_child) {
+        //points parent (or the root) at new_child instead of old_child
+        if (parent == -1) {
+            root = new_child;
+        } else if (nodes[parent].left == old_child) {
+            nodes[parent].left = new_child;
+        } else {
+            nodes[parent].right = new_child;
+        }
+    }
+
+    template<typename F>
+    void query_leaves(const aabb& box, F&& func) {
+        //calls func(leaf) for every leaf whose fat box overlaps box, stops if func returns true
+        if (root == -1) return;
+
+        //the stack never holds more than the height of the tree plus one
+        int small_stack[128];
+        std::vector<int> big_stack;
+        int* stack = small_stack;
+        if (nodes[root].height + 2 > 128) {
+            big_stack.resize(nodes[root].height + 2);
+            stack = big_stack.data();
+        }
+
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            int id = stack[--top];
+            const node& n = nodes[id];
+            if (!n.box.overlaps(box)) continue;
+
+            if (is_leaf(id)) {
+                if (func(id)) return;
+            } else {
+                stack[top++] = n.left;
+                stack[top++] = n.right;
+            }
+        }
+    }
+
+    public:
+
+    aabb_tree(float fat_margin = 4.0f) {
+        //creates an empty tree, fat_margin is how far (in pixels) a rect can move before its leaf has to be moved
+        margin = fat_margin;
+    }
+
+    int insert(rect* r, void* user = nullptr) {
+        //adds a rect to the tree and returns its proxy id, used to update or remove it later on
+        int leaf = allocate_node();
+        nodes[leaf].box = aabb::from_rect(*r, margin);
+        nodes[leaf].r = r;
+        nodes[leaf].user = user;
+        insert_leaf(leaf);
+        proxy_count++;
+        return leaf;
+    }
+
+    void remove(int proxy) {
+        //takes a rect out of the tree
+        if (proxy < 0 || proxy >= static_cast<int>(nodes.size()) || nodes[proxy].height != 0 || !is_leaf(proxy)) return;
+        remove_leaf(proxy);
+        free_node(proxy);
+        proxy_count--;
+    }
+
+    bool update(int proxy) {
+        //call after the rect moved, returns true if its leaf had to be moved
+        aabb tight = aabb::from_rect(*nodes[proxy].r);
+        if (nodes[proxy].box.contains(tight)) return false;
+
+        remove_leaf(proxy);
+        nodes[proxy].box = aabb::from_rect(*nodes[proxy].r, margin);
+        insert_leaf(proxy);
+        return true;
+    }
+
+    template<typename F>
+    void query(const rect& area, F&& func) {
+        /*
+        calls func(rect*, void* user) for every rect in the tree that collides with area
+        if func returns true the query stops
+        */
+        query_leaves(aabb::from_rect(area), [&](int leaf) {
+            return collide_rect(*nodes[leaf].r, area) && func(nodes[leaf].r, nodes[leaf].user);
+        });
+    }
+
+    void find_pairs(std::vector<aabb_pair>& out) {
+        //appends every pair of rects in the tree that collide to out, each pair only once
+        for (int i = 0; i < static_cast<int>(nodes.size()); i++) {
+            if (nodes[i].height != 0 || !is_leaf(i)) continue;
+
+            const rect& r = *nodes[i].r;
+            query_leaves(aabb::from_rect(r), [&](int leaf) {
+                //every pair is found from both of its leaves, only keep it from the lower one
+                if (leaf > i && collide_rect(r, *nodes[leaf].r)) {
+                    out.push_back({nodes[i].r, nodes[leaf].r, nodes[i].user, nodes[leaf].user});
+                }
+                return false;
+            });
+        }
+    }
+
+    std::vector<aabb_pair> find_pairs() {
+        //returns every pair of rects in the tree that collide
+        std::vector<aabb_pair> out;
+        find_pairs(out);
+        return out;
+    }
+
+    int get_height() {
+        //returns the height of the tree, a balanced tree is about log2(size) tall
+        return root == -1 ? 0 : nodes[root].height;
+    }
+
+    int size() {
+        //returns how many rects are in the tree
+        return proxy_count;
+    }
+
+    void clear() {
+        //removes everything
+        nodes.clear();
+        root = -1;
+        free_list = -1;
+        proxy_count = 0;
+    }
+};
+
+
+#endif
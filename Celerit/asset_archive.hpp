@@ -0,0 +1,247 @@
+#ifndef ASSET_ARCHIVE
+#define ASSET_ARCHIVE
+
+#include "util.hpp"
+#include "renderer.hpp"
+#include "font.hpp"
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+#ifdef _WIN32
+//windows.h defines min and max as macros otherwise, which breaks std::min and std::max everywhere after it
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/*
+The layout of a packed asset archive (.pak), written by tools/celerit_pack.cpp and read by asset_archive
+every number is little endian, written and read a byte at a time so archives are the same on every host
+
+    header              see archive_format::header
+    file data           each file starts on a DATA_ALIGN boundary
+    table of contents   entry_count entries of: uint64 offset, uint64 size, uint32 name length, name bytes (no terminator)
+
+names are the paths the files were packed with, always using '/' as the separator
+*/
+namespace archive_format {
+    constexpr char MAGIC[8] = {'C', 'L', 'R', 'P', 'A', 'K', '\r', '\n'};
+    constexpr uint32_t VERSION = 1;
+    constexpr uint64_t DATA_ALIGN = 16;
+
+    //the header is HEADER_SIZE bytes on disk, in the order of the fields here
+    constexpr uint64_t HEADER_SIZE = 32;
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_count;
+        uint64_t toc_offset;
+        uint64_t toc_size;
+    };
+
+    template<typename T>
+    void put_le(std::ostream& os, T v) {
+        //writes an unsigned number lowest byte first
+        for (size_t i = 0; i < sizeof(T); i++) os.put(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    template<typename T>
+    T get_le(const char* p) {
+        //reads an unsigned number written by put_le
+        T v = 0;
+        for (size_t i = 0; i < sizeof(T); i++) v |= static_cast<T>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return v;
+    }
+
+    inline void write_header(std::ostream& os, const header& h) {
+        os.write(h.magic, sizeof(h.magic));
+        put_le(os, h.version);
+        put_le(os, h.entry_count);
+        put_le(os, h.toc_offset);
+        put_le(os, h.toc_size);
+    }
+
+    inline header read_header(const char* p) {
+        //p has to point at HEADER_SIZE bytes
+        header h;
+        memcpy(h.magic, p, sizeof(h.magic));
+        h.version = get_le<uint32_t>(p + 8);
+        h.entry_count = get_le<uint32_t>(p + 12);
+        h.toc_offset = get_le<uint64_t>(p + 16);
+        h.toc_size = get_le<uint64_t>(p + 24);
+        return h;
+    }
+}
+
+
+/*
+A read only archive of assets, the whole file is memory mapped so opening it is one system call no matter how many assets it has
+assets are handed to SDL straight from the mapping, nothing is copied
+
+    asset_archive pak("assets.pak");
+    renderer::texture_handle tree = pak.load_texture(rend, "props/tree.png");
+    font ui_font(pak.get_data("fonts/ui.ttf").data(), pak.get_data("fonts/ui.ttf").size(), 14);
+
+anything made from the archive without being copied (fonts, raw data) must not outlive it
+*/
+class asset_archive {
+    private:
+    struct entry {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    string path;
+    const char* data = nullptr;
+    size_t data_size = 0;
+    unordered_map<string, entry> entries;
+
+    #ifdef _WIN32
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping_handle = nullptr;
+    #endif
+
+    void fail(const string& why) {
+        cerr << "Error: could not open asset archive " << path << ": " << why << "\n";
+        exit(-1);
+    }
+
+    void map_file() {
+        //maps the whole archive read only
+        #ifdef _WIN32
+        file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) fail("could not open the file");
+        LARGE_INTEGER size;
+        GetFileSizeEx(file_handle, &size);
+        data_size = (size_t)size.QuadPart;
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle == nullptr) fail("could not map the file");
+        data = (const char*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr) fail("could not map the file");
+        #else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) fail(strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0) fail(strerror(errno));
+        data_size = (size_t)st.st_size;
+        if (data_size < archive_format::HEADER_SIZE) fail("the file is too small to be an archive");
+        void* mapped = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        //the mapping keeps the file alive, the descriptor isnt needed anymore
+        close(fd);
+        if (mapped == MAP_FAILED) fail(strerror(errno));
+        data = (const char*)mapped;
+        #endif
+    }
+
+    template<typename T>
+    T read_at(uint64_t offset) {
+        //reads a little endian number from the mapping
+        return archive_format::get_le<T>(data + offset);
+    }
+
+    void read_toc() {
+        //checks the header and indexes every file by name
+        if (data_size < archive_format::HEADER_SIZE) fail("the file is too small to be an archive");
+        archive_format::header h = archive_format::read_header(data);
+        if (memcmp(h.magic, archive_format::MAGIC, sizeof(h.magic)) != 0) fail("not an asset archive");
+        if (h.version != archive_format::VERSION) fail("unsupported archive version " + std::to_string(h.version));
+        if (h.toc_offset > data_size || h.toc_size > data_size - h.toc_offset) fail("the table of contents is out of bounds");
+
+        uint64_t at = h.toc_offset;
+        uint64_t end = h.toc_offset + h.toc_size;
+        entries.reserve(h.entry_count);
+        for (uint32_t i = 0; i < h.entry_count; i++) {
+            if (end - at < 20) fail("the table of contents is truncated");
+            entry e;
+            e.offset = read_at<uint64_t>(at);
+            e.size = read_at<uint64_t>(at + 8);
+            uint32_t name_length = read_at<uint32_t>(at + 16);
+            at += 20;
+            if (end - at < name_length) fail("the table of contents is truncated");
+            if (e.offset > data_size || e.size > data_size - e.offset) fail("a file is out of bounds");
+            entries.emplace(string(data + at, name_length), e);
+            at += name_length;
+        }
+    }
+
+    public:
+
+    asset_archive(const string& archive_path) {
+        //opens and maps an archive made with celerit_pack
+        path = archive_path;
+        map_file();
+        read_toc();
+    }
+
+    asset_archive(const asset_archive&) = delete;
+    asset_archive& operator=(const asset_archive&) = delete;
+
+    bool contains(const string& name) const {
+        return entries.find(name) != entries.end();
+    }
+
+    size_t size() const {
+        //the number of files in the archive
+        return entries.size();
+    }
+
+    std::string_view get_data(const string& name) const {
+        //returns the bytes of a packed file, straight from the mapping
+        auto found = entries.find(name);
+        if (found == entries.end()) {
+            cerr << "Error: " << name << " is not in asset archive " << path << "\n";
+            exit(-1);
+        }
+        return std::string_view(data + found->second.offset, (size_t)found->second.size);
+    }
+
+    SDL_RWops* open_rw(const string& name) const {
+        //returns a read only SDL_RWops over a packed file for any SDL loader, free it with SDL_RWclose (or let the loader do it)
+        std::string_view bytes = get_data(name);
+        return SDL_RWFromConstMem(bytes.data(), (int)bytes.size());
+    }
+
+    renderer::texture_handle load_texture(renderer& r, const string& name) const {
+        //loads a packed image through the renderers texture cache, cached under "<archive path>:<name>"
+        string key = path + ":" + name;
+        renderer::texture_handle found = r.find_texture(key);
+        if (!found.is_null()) return found;
+
+        SDL_Texture* t = IMG_LoadTexture_RW(r.get_sdl_renderer(), open_rw(name), 1);
+        if (t == nullptr) {
+            cerr << "Error: could not load texture " << key << ": " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+        return r.adopt_texture(key, t);
+    }
+
+    font* open_font(const string& name, int ptsize) const {
+        //opens a packed ttf at <ptsize>, the font reads from the archive so delete it before the archive goes away
+        std::string_view bytes = get_data(name);
+        return new font(bytes.data(), bytes.size(), ptsize);
+    }
+
+    ~asset_archive() {
+        #ifdef _WIN32
+        if (data != nullptr) UnmapViewOfFile(data);
+        if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+        if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+        #else
+        if (data != nullptr) munmap((void*)data, data_size);
+        #endif
+    }
+};
+
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef ASSET_LOADER
+#define ASSET_LOADER
+
+#include "util.hpp"
+#include "renderer.hpp"
+#include "font.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+//the state of an asynchronous load
+enum class load_status {
+    pending,
+    ready,
+    failed
+};
+
+
+/*
+Loads textures and fonts in the background so level transitions dont stall the frame
+
+images are decoded on worker threads with IMG_Load, but textures can only be created on the thread that owns the renderer,
+so the decoded surfaces wait until asset_loader::update is called (once a frame) which uploads as many as fit in the upload budget
+fonts are read into memory on the workers and opened in asset_loader::update too, SDL_ttf isnt safe to use from two threads
+
+    asset_loader loader(rend);
+    async_texture tree = loader.load_texture("tree.png");
+    //every frame:
+    loader.update();
+    rend.blit_texture(tree.get(), 10, 10);//draws a placeholder until the real texture is uploaded
+
+finished textures go into the renderers texture cache, so they are shared with renderer::load_texture
+*/
+class asset_loader;
+
+
+//a texture that is being loaded by an asset_loader, copying one is cheap and all copies see the same load
+//the placeholder belongs to the loader, so dont call async_texture::get after the loader is destroyed unless the load is ready
+class async_texture {
+    friend class asset_loader;
+    private:
+    struct state {
+        string path;
+        //written by a worker, read on the main thread once the status says it is decoded
+        SDL_Surface* surface = nullptr;
+        string error;
+        std::atomic<load_status> status{load_status::pending};
+        renderer::texture_handle handle;
+
+        ~state() {
+            if (surface != nullptr) SDL_FreeSurface(surface);
+        }
+    };
+
+    std::shared_ptr<state> s;
+    texture* placeholder = nullptr;
+
+    async_texture(std::shared_ptr<state> st, texture* ph) : s(std::move(st)), placeholder(ph) {}
+
+    public:
+    async_texture() {}//creates an empty request
+
+    load_status get_status() const {
+        return s == nullptr ? load_status::failed : s->status.load(std::memory_order_acquire);
+    }
+
+    bool is_ready() const {
+        return get_status() == load_status::ready;
+    }
+
+    bool has_failed() const {
+        return get_status() == load_status::failed;
+    }
+
+    const string& get_error() const {
+        //why the load failed, only valid once async_texture::has_failed is true
+        return s->error;
+    }
+
+    texture& get() const {
+        //returns the loaded texture, or the loaders placeholder texture while it isnt ready (or if it failed)
+        if (is_ready()) return s->handle.get();
+        return *placeholder;
+    }
+
+    renderer::texture_handle get_handle() const {
+        //returns a handle to the loaded texture, null until the load is ready
+        if (!is_ready()) return renderer::texture_handle();
+        return s->handle;
+    }
+};
+
+
+//a font that is being loaded by an asset_loader, it is ready once asset_loader::update has opened the file a worker read
+class async_font {
+    friend class asset_loader;
+    private:
+    struct state {
+        string path;
+        int size;
+        //the whole file, the font is opened from it without copying so it lives as long as the font
+        std::vector<char> bytes;
+        std::unique_ptr<font> fnt;
+        string error;
+        std::atomic<load_status> status{load_status::pending};
+    };
+
+    std::shared_ptr<state> s;
+
+    async_font(std::shared_ptr<state> st) : s(std::move(st)) {}
+
+    public:
+    async_font() {}//creates an empty request
+
+    load_status get_status() const {
+        return s == nullptr ? load_status::failed : s->status.load(std::memory_order_acquire);
+    }
+
+    bool is_ready() const {
+        return get_status() == load_status::ready;
+    }
+
+    bool has_failed() const {
+        return get_status() == load_status::failed;
+    }
+
+    const string& get_error() const {
+        return s->error;
+    }
+
+    font* get() const {
+        //returns the loaded font, or nullptr while it isnt ready, the font lives as long as any copy of this request
+        if (!is_ready()) return nullptr;
+        return s->fnt.get();
+    }
+};
+
+
+class asset_loader {
+    private:
+    renderer* rend;
+    //what async_texture::get hands out until the real texture arrives
+    texture placeholder;
+
+    //the worker pool and the jobs waiting for it
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_cv;
+    bool stopping = false;
+
+    //surfaces a worker has finished decoding (or failed to), waiting to be uploaded on the main thread
+    std::deque<std::shared_ptr<async_texture::state>> decoded;
+    //font files a worker has read (or failed to), waiting to be opened on the main thread
+    std::deque<std::shared_ptr<async_font::state>> read_fonts;
+    std::mutex decoded_mutex;
+
+    //textures that are still loading, so asking for the same file twice doesnt decode it twice (main thread only)
+    unordered_map<string, std::weak_ptr<async_texture::state>> in_flight;
+
+    //how long asset_loader::update may spend creating textures each frame
+    seconds_t upload_budget;
+    int uploaded_last_update = 0;
+
+    void worker_loop() {
+        //runs jobs until the loader is destroyed
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(jobs_mutex);
+                jobs_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    void push_job(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            jobs.push_back(std::move(job));
+        }
+        jobs_cv.notify_one();
+    }
+
+    void make_placeholder() {
+        //a small magenta and black checkerboard, easy to spot if something never finishes loading
+        SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 32, SDL_PIXELFORMAT_RGBA32);
+        if (surf == nullptr) {
+            cerr << "Error: could not create the asset_loader placeholder: " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                SDL_Rect px = {x, y, 1, 1};
+                bool magenta = ((x / 4) + (y / 4)) % 2 == 0;
+                SDL_FillRect(surf, &px, SDL_MapRGBA(surf->format, magenta ? 255 : 0, 0, magenta ? 255 : 0, 255));
+            }
+        }
+        placeholder = texture(SDL_CreateTextureFromSurface(rend->get_sdl_renderer(), surf));
+        SDL_FreeSurface(surf);
+    }
+
+    public:
+
+    asset_loader(renderer& r, int worker_count = 2, seconds_t upload_budget_seconds = 0.002) {
+        //creates a loader with <worker_count> decoding threads that uploads for at most <upload_budget_seconds> per update
+        rend = &r;
+        upload_budget = upload_budget_seconds;
+        make_placeholder();
+
+        if (worker_count < 1) worker_count = 1;
+        for (int i = 0; i < worker_count; i++) {
+            workers.emplace_back(&asset_loader::worker_loop, this);
+        }
+    }
+
+    asset_loader(const asset_loader&) = delete;
+    asset_loader& operator=(const asset_loader&) = delete;
+
+    async_texture load_texture(const string& file) {
+        //starts loading an image, if it is already in the renderers texture cache the request is ready right away
+        std::shared_ptr<async_texture::state> s = std::make_shared<async_texture::state>();
+        s->path = file;
+
+        renderer::texture_handle cached = rend->find_texture(file);
+        if (!cached.is_null()) {
+            s->handle = cached;
+            s->status.store(load_status::ready, std::memory_order_release);
+            return async_texture(s, &placeholder);
+        }
+
+        auto loading = in_flight.find(file);
+        if (loading != in_flight.end()) {
+            std::shared_ptr<async_texture::state> existing = loading->second.lock();
+            if (existing != nullptr && existing->status.load(std::memory_order_acquire) == load_status::pending) {
+                return async_texture(existing, &placeholder);
+            }
+        }
+        in_flight[file] = s;
+
+        push_job([this, s] {
+            //failures go through asset_loader::update aswell, so it can take the request out of in_flight
+            s->surface = IMG_Load(s->path.c_str());
+            if (s->surface == nullptr) s->error = SDL_GetError();
+            std::lock_guard<std::mutex> lock(decoded_mutex);
+            decoded.push_back(s);
+        });
+        return async_texture(s, &placeholder);
+    }
+
+    async_font load_font(const string& file, int ptsize) {
+        //starts loading a font, a worker reads the file and the next asset_loader::update opens it
+        std::shared_ptr<async_font::state> s = std::make_shared<async_font::state>();
+        s->path = file;
+        s->size = ptsize;
+
+        push_job([this, s] {
+            std::ifstream in(s->path, std::ios::binary);
+            if (!in) {
+                s->error = "could not open " + s->path;
+            } else {
+                s->bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                if (s->bytes.empty()) s->error = s->path + " is empty";
+            }
+            std::lock_guard<std::mutex> lock(decoded_mutex);
+            read_fonts.push_back(s);
+        });
+        return async_font(s);
+    }
+
+    void update() {
+        /*
+        uploads decoded images to textures and opens read fonts, call once a frame from the thread that owns the renderer
+        at least one texture is uploaded every call so loading always makes progress, even with a tiny budget
+        */
+        steady_clock::time_point start = steady_clock::now();
+        uploaded_last_update = 0;
+
+        //fonts are cheap to open once theyre in memory, so they dont count against the budget
+        while (true) {
+            std::shared_ptr<async_font::state> f;
+            {
+                std::lock_guard<std::mutex> lock(decoded_mutex);
+                if (read_fonts.empty()) break;
+                f = std::move(read_fonts.front());
+                read_fonts.pop_front();
+            }
+            if (f->error.empty()) {
+                std::unique_ptr<font> opened(new font(f->bytes.data(), f->bytes.size(), f->size));
+                if (opened->get_sdl_font() == nullptr) f->error = SDL_GetError();
+                else f->fnt = std::move(opened);
+            }
+            f->status.store(f->fnt != nullptr ? load_status::ready : load_status::failed, std::memory_order_release);
+        }
+
+        while (true) {
+            std::shared_ptr<async_texture::state> s;
+            {
+                std::lock_guard<std::mutex> lock(decoded_mutex);
+                if (decoded.empty()) break;
+                s = std::move(decoded.front());
+                decoded.pop_front();
+            }
+
+            if (s->surface == nullptr) {
+                //the decode failed, the worker already set the error
+                s->status.store(load_status::failed, std::memory_order_release);
+                in_flight.erase(s->path);
+                continue;
+            }
+
+            SDL_Texture* t = SDL_CreateTextureFromSurface(rend->get_sdl_renderer(), s->surface);
+            SDL_FreeSurface(s->surface);
+            s->surface = nullptr;
+            if (t == nullptr) {
+                s->error = SDL_GetError();
+                s->status.store(load_status::failed, std::memory_order_release);
+            } else {
+                s->handle = rend->adopt_texture(s->path, t);
+                s->status.store(load_status::ready, std::memory_order_release);
+            }
+            in_flight.erase(s->path);
+            uploaded_last_update++;
+
+            seconds_t spent = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1000000000.0L;
+            if (spent >= upload_budget) break;
+        }
+    }
+
+    void set_upload_budget(seconds_t seconds) {
+        upload_budget = seconds;
+    }
+
+    int get_uploaded_last_update() {
+        //the number of textures the last asset_loader::update uploaded
+        return uploaded_last_update;
+    }
+
+    size_t get_pending_uploads() {
+        //the number of decoded (or failed) images waiting for asset_loader::update
+        std::lock_guard<std::mutex> lock(decoded_mutex);
+        return decoded.size();
+    }
+
+    texture& get_placeholder() {
+        return placeholder;
+    }
+
+    ~asset_loader() {
+        //jobs that havent started are dropped, their requests stay pending forever
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            stopping = true;
+        }
+        jobs_cv.notify_all();
+        for (std::thread& w: workers) w.join();
+        rend->destroy_texture(placeholder);
+    }
+};
+
+
+#endif
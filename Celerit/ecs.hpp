@@ -0,0 +1,448 @@
+#ifndef ECS
+#define ECS
+
+#include "util.hpp"
+#include "renderer.hpp"
+#include "render_snapshot.hpp"
+#include "job_system.hpp"
+#include "sprite.hpp"
+#include <memory>
+#include <type_traits>
+
+
+/*
+An entity component system, an alternative to sprite_group for large numbers of simple objects
+
+entities are just ids, components are plain structs kept in one tightly packed array per component type (a sparse set),
+and systems are functions that walk those arrays in order instead of calling a virtual function per object
+
+    ecs::world w;
+    ecs::entity e = w.create();
+    w.add<ecs::transform>(e, dvec2{100, 100});
+    w.add<ecs::velocity>(e, dvec2{30, 0});
+    w.add<ecs::sprite_ref>(e, tex);
+
+    ecs::integrate_motion(w, clk.get_dt());
+    ecs::draw_sprites(w, rend);
+
+existing sprite subclasses can be put in a world as they are with ecs::adopt_sprite, and moved over to components one at a time
+*/
+namespace ecs {
+    //an index in the low 20 bits and a version in the high 12, so a destroyed entitys id isnt valid once the index is reused
+    typedef uint32_t entity;
+    constexpr entity NULL_ENTITY = 0xFFFFFFFF;
+    constexpr uint32_t INDEX_BITS = 20;
+    constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+
+    inline uint32_t entity_index(entity e) {
+        return e & INDEX_MASK;
+    }
+
+    inline uint32_t entity_version(entity e) {
+        return e >> INDEX_BITS;
+    }
+
+    /*
+    the type independent half of a component pool, entities are packed into dense, and sparse maps an entity index to
+    where it is in dense, so checking for and finding a component are both one lookup
+    */
+    class sparse_set {
+        protected:
+        std::vector<uint32_t> sparse;
+        std::vector<entity> dense;
+
+        uint32_t insert_entity(entity e) {
+            uint32_t index = entity_index(e);
+            if (index >= sparse.size()) sparse.resize(index + 1, NO_SLOT);
+            sparse[index] = static_cast<uint32_t>(dense.size());
+            dense.push_back(e);
+            return sparse[index];
+        }
+
+        uint32_t erase_entity(entity e) {
+            //swaps the last entity into es slot, returns the slot so the component array can do the same
+            uint32_t slot = sparse[entity_index(e)];
+            entity last = dense.back();
+            dense[slot] = last;
+            sparse[entity_index(last)] = slot;
+            dense.pop_back();
+            sparse[entity_index(e)] = NO_SLOT;
+            return slot;
+        }
+
+        public:
+        virtual ~sparse_set() {}
+
+        bool contains(entity e) const {
+            uint32_t index = entity_index(e);
+            return index < sparse.size() && sparse[index] != NO_SLOT && dense[sparse[index]] == e;
+        }
+
+        size_t size() const {
+            return dense.size();
+        }
+
+        const std::vector<entity>& entities() const {
+            //every entity with the component, in the same order as the components
+            return dense;
+        }
+
+        virtual void remove(entity e) = 0;
+    };
+
+    //every component of one type, packed in the same order as the entities that own them
+    template<typename T>
+    class component_pool : public sparse_set {
+        private:
+        std::vector<T> data;
+
+        public:
+
+        template<typename... Args>
+        T& emplace(entity e, Args&&... args) {
+            //gives e a component, replacing the one it has
+            if (contains(e)) {
+                T& existing = data[sparse[entity_index(e)]];
+                existing = T{std::forward<Args>(args)...};
+                return existing;
+            }
+            uint32_t index = entity_index(e);
+            if (index < sparse.size() && sparse[index] != NO_SLOT) {
+                //the index belongs to a newer entity, e is a stale handle and inserting it would orphan that entitys component
+                cerr << "Error: adding a component to a destroyed entity (" << e << ")\n";
+                exit(-1);
+            }
+            insert_entity(e);
+            data.push_back(T{std::forward<Args>(args)...});
+            return data.back();
+        }
+
+        void remove(entity e) override {
+            if (!contains(e)) return;
+            uint32_t slot = erase_entity(e);
+            if (slot != data.size() - 1) data[slot] = std::move(data.back());
+            data.pop_back();
+        }
+
+        T& get(entity e) {
+            //the entity has to have the component, check with component_pool::contains first if youre not sure
+            return data[sparse[entity_index(e)]];
+        }
+
+        T* try_get(entity e) {
+            return contains(e) ? &data[sparse[entity_index(e)]] : nullptr;
+        }
+
+        T* components() {
+            //the packed array of components, component i belongs to entities()[i]
+            return data.data();
+        }
+
+        std::vector<T>& get_components() {
+            return data;
+        }
+    };
+
+    inline size_t next_component_id() {
+        static size_t next = 0;
+        return next++;
+    }
+
+    template<typename T>
+    size_t component_id() {
+        //a small number per component type, so pools can be found by indexing instead of hashing
+        static const size_t id = next_component_id();
+        return id;
+    }
+
+    /*
+    owns the entities and a pool for every component type used with it
+    adding or removing components of a type invalidates references to components of that type,
+    so dont do it from inside world::each over that type
+    */
+    class world {
+        private:
+        std::vector<std::unique_ptr<sparse_set>> pools;
+        //the current version of every entity index, and the indices free to be reused
+        std::vector<uint32_t> versions;
+        std::vector<uint32_t> free_indices;
+        size_t alive_count = 0;
+
+        template<typename F, typename A, typename... Rest>
+        static void each_in(F& func, component_pool<A>& first, component_pool<Rest>&... rest) {
+            const std::vector<entity>& ents = first.entities();
+            A* comps = first.components();
+            for (size_t i = 0; i < ents.size(); i++) {
+                entity e = ents[i];
+                if ((rest.contains(e) && ...)) func(e, comps[i], rest.get(e)...);
+            }
+        }
+
+        public:
+
+        world() {}
+        world(const world&) = delete;
+        world& operator=(const world&) = delete;
+
+        entity create() {
+            //creates an entity with no components
+            uint32_t index;
+            if (!free_indices.empty()) {
+                index = free_indices.back();
+                free_indices.pop_back();
+            } else {
+                index = static_cast<uint32_t>(versions.size());
+                if (index > INDEX_MASK) {
+                    cerr << "Error: an ecs::world can only hold " << INDEX_MASK + 1 << " entities\n";
+                    exit(-1);
+                }
+                versions.push_back(0);
+            }
+            alive_count++;
+            return (versions[index] << INDEX_BITS) | index;
+        }
+
+        bool is_alive(entity e) const {
+            uint32_t index = entity_index(e);
+            return e != NULL_ENTITY && index < versions.size() && versions[index] == entity_version(e);
+        }
+
+        void destroy(entity e) {
+            //removes every component of e, then frees its id
+            if (!is_alive(e)) return;
+            for (std::unique_ptr<sparse_set>& p: pools) {
+                if (p != nullptr) p->remove(e);
+            }
+            uint32_t index = entity_index(e);
+            uint32_t next = (versions[index] + 1) & (0xFFFFFFFF >> INDEX_BITS);
+            //the last index at the last version would be NULL_ENTITY, so that one version is skipped
+            if (((next << INDEX_BITS) | index) == NULL_ENTITY) next = 0;
+            versions[index] = next;
+            free_indices.push_back(index);
+            alive_count--;
+        }
+
+        size_t get_entity_count() const {
+            return alive_count;
+        }
+
+        template<typename T>
+        component_pool<T>& pool() {
+            //the pool for a component type, made the first time the type is used
+            size_t id = component_id<T>();
+            if (id >= pools.size()) pools.resize(id + 1);
+            if (pools[id] == nullptr) pools[id] = std::make_unique<component_pool<T>>();
+            return *static_cast<component_pool<T>*>(pools[id].get());
+        }
+
+        template<typename T, typename... Args>
+        T& add(entity e, Args&&... args) {
+            //gives e a T made from args (aggregate initialization), replacing any T it already has
+            if (!is_alive(e)) {
+                cerr << "Error: adding a component to a destroyed entity (" << e << ")\n";
+                exit(-1);
+            }
+            return pool<T>().emplace(e, std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        void remove(entity e) {
+            pool<T>().remove(e);
+        }
+
+        template<typename T>
+        bool has(entity e) {
+            return pool<T>().contains(e);
+        }
+
+        template<typename T>
+        T& get(entity e) {
+            return pool<T>().get(e);
+        }
+
+        template<typename T>
+        T* try_get(entity e) {
+            return pool<T>().try_get(e);
+        }
+
+        template<typename A, typename... Rest, typename F>
+        void each(F&& func) {
+            /*
+            calls func(entity, A&, Rest&...) for every entity that has all of the components
+            the A array is walked in order and the others are looked up, so put the component fewest entities have first
+            */
+            each_in(func, pool<A>(), pool<Rest>()...);
+        }
+    };
+
+
+    //where an entity is
+    struct transform {
+        dvec2 position = {0, 0};
+        arcdegrees angle = 0;
+    };
+
+    //how an entity moves, per second
+    struct velocity {
+        dvec2 linear = {0, 0};
+        dvec2 acceleration = {0, 0};
+    };
+
+    //a collision rect that follows the entitys transform, offset from its position
+    struct collider {
+        rect box = {{0, 0, 0, 0}};
+        ivec2 offset = {0, 0};
+    };
+
+    //what an entity looks like, a texture (or part of one with use_source) drawn at its transform
+    struct sprite_ref {
+        texture tex;
+        bool use_source = false;
+        rect source = {{0, 0, 0, 0}};
+        color tint = WHITE;
+        SDL_RendererFlip flip = SDL_FLIP_NONE;
+    };
+
+    /*
+    an existing sprite living in a world, updated and drawn through its virtual functions like in a sprite_group
+    its transform and collider components are kept in sync with it so systems can see it
+    */
+    struct legacy_sprite {
+        sprite* ptr = nullptr;
+        //set when the world owns the sprite, see ecs::create_legacy_sprite
+        std::shared_ptr<sprite> owned;
+    };
+
+
+    inline void integrate_motion(world& w, seconds_t dt) {
+        //moves every entity with a velocity and a transform
+        double step = static_cast<double>(dt);
+        component_pool<transform>& transforms = w.pool<transform>();
+        w.each<velocity>([&](entity e, velocity& v) {
+            transform* t = transforms.try_get(e);
+            if (t == nullptr) return;
+            t->position.x += v.linear.x * step;
+            t->position.y += v.linear.y * step;
+            v.linear.x += v.acceleration.x * step;
+            v.linear.y += v.acceleration.y * step;
+        });
+    }
+
+    inline void integrate_motion(world& w, seconds_t dt, job_system& jobs, int chunk_size = 4096) {
+        //integrate_motion split up across the job systems workers, every entity touches only its own components
+        double step = static_cast<double>(dt);
+        component_pool<velocity>& velocities = w.pool<velocity>();
+        component_pool<transform>& transforms = w.pool<transform>();
+        const std::vector<entity>& ents = velocities.entities();
+        velocity* vels = velocities.components();
+        jobs.parallel_for(0, static_cast<int>(ents.size()), [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+                transform* t = transforms.try_get(ents[i]);
+                if (t == nullptr) continue;
+                velocity& v = vels[i];
+                t->position.x += v.linear.x * step;
+                t->position.y += v.linear.y * step;
+                v.linear.x += v.acceleration.x * step;
+                v.linear.y += v.acceleration.y * step;
+            }
+        }, chunk_size);
+    }
+
+    inline void sync_colliders(world& w) {
+        //moves every collider to its entitys transform
+        w.each<collider, transform>([](entity, collider& c, transform& t) {
+            c.box.x = static_cast<int>(t.position.x) + c.offset.x;
+            c.box.y = static_cast<int>(t.position.y) + c.offset.y;
+        });
+    }
+
+    inline void collect_colliding(world& w, rect area, std::vector<entity>& out) {
+        //appends every entity whose collider overlaps area to out
+        w.each<collider>([&](entity e, collider& c) {
+            if (collide_rect(c.box, area)) out.push_back(e);
+        });
+    }
+
+    inline rect sprite_dest(sprite_ref& s, transform& t, dvec2 scroll) {
+        rect size = s.use_source ? s.source : s.tex.get_rect();
+        return rect{{static_cast<int>(round(t.position.x - scroll.x)), static_cast<int>(round(t.position.y - scroll.y)), size.w, size.h}};
+    }
+
+    inline void draw_sprites(world& w, renderer& r, dvec2 scroll = {0, 0}) {
+        //draws every entity with a sprite_ref and a transform, in the order the sprite_refs were added
+        w.each<sprite_ref, transform>([&](entity, sprite_ref& s, transform& t) {
+            rect dest = sprite_dest(s, t, scroll);
+            rect source = s.use_source ? s.source : s.tex.get_rect();
+            r.queue_texture(s.tex, source, dest, t.angle, {dest.w / 2.0, dest.h / 2.0}, s.flip, s.tint);
+        });
+        if (!r.get_batching()) r.flush_batch();
+    }
+
+    inline void capture_sprites(world& w, render_snapshot& snap, dvec2 scroll = {0, 0}) {
+        //adds the same quads draw_sprites would draw to a snapshot, for frame_pipeline
+        w.each<sprite_ref, transform>([&](entity, sprite_ref& s, transform& t) {
+            rect dest = sprite_dest(s, t, scroll);
+            rect source = s.use_source ? s.source : s.tex.get_rect();
+            snap.add(s.tex, source, dest, t.angle, {dest.w / 2.0, dest.h / 2.0}, s.tint, s.flip);
+        });
+    }
+
+
+    //the bridge for sprite subclasses
+
+    inline void sync_legacy(world& w, entity e, sprite* s) {
+        //copies a sprites position and collision rect into its entitys components
+        if (!w.is_alive(e)) return;
+        transform& t = w.has<transform>(e) ? w.get<transform>(e) : w.add<transform>(e);
+        t.position = s->get_pos();
+        collider& c = w.has<collider>(e) ? w.get<collider>(e) : w.add<collider>(e);
+        c.box = s->get_rect();
+        c.offset = {0, 0};
+    }
+
+    inline entity adopt_sprite(world& w, sprite* s) {
+        //puts an existing sprite in the world without taking ownership of it, it has to outlive the entity
+        entity e = w.create();
+        w.add<legacy_sprite>(e, s, nullptr);
+        sync_legacy(w, e, s);
+        return e;
+    }
+
+    template<typename T, typename = std::enable_if_t<std::is_base_of_v<sprite, T>>>
+    entity create_legacy_sprite(world& w, T instance) {
+        //like sprite_group::create_sprite, the world owns the sprite and deletes it along with the entity
+        std::shared_ptr<sprite> owned = std::make_shared<T>(std::move(instance));
+        entity e = w.create();
+        w.add<legacy_sprite>(e, owned.get(), owned);
+        sync_legacy(w, e, owned.get());
+        return e;
+    }
+
+    inline void update_legacy(world& w, seconds_t dt) {
+        //calls fixed_update(dt) on every adopted sprite, then syncs its components
+        w.each<legacy_sprite>([&](entity, legacy_sprite& l) {
+            l.ptr->fixed_update(dt);
+        });
+        w.each<legacy_sprite>([&](entity e, legacy_sprite& l) {
+            sync_legacy(w, e, l.ptr);
+        });
+    }
+
+    inline void draw_legacy(world& w) {
+        //calls draw on every adopted sprite
+        w.each<legacy_sprite>([](entity, legacy_sprite& l) {
+            l.ptr->draw();
+        });
+    }
+
+    inline void capture_legacy(world& w, render_snapshot& snap, dvec2 scroll = {0, 0}) {
+        //adds every adopted sprite to a snapshot through sprite::capture
+        w.each<legacy_sprite>([&](entity, legacy_sprite& l) {
+            l.ptr->capture(snap, scroll);
+        });
+    }
+}
+
+
+#endif
@@ -2,6 +2,38 @@
 #define FONT
 
 #include "util.hpp"
+#include <algorithm>
+#include <memory>
+
+//a glyph that has been rasterized into one of a fonts atlas pages
+struct atlas_glyph {
+    //which page the glyph lives on and where
+    int page;
+    SDL_Rect src;
+};
+
+//a page of a fonts glyph atlas, glyphs are packed onto it in shelves (rows)
+struct atlas_page {
+    SDL_Texture* tex;
+    int w;
+    int h;
+    int shelf_x;
+    int shelf_y;
+    int shelf_h;
+};
+
+//a glyph placed in a line of text, x is relative to the left of the line
+struct placed_glyph {
+    int page;
+    SDL_Rect src;
+    int x;
+};
+
+//a laid out line of text, keeps the glyphs positions and the measured size so it can be redrawn without touching SDL_ttf
+struct text_layout {
+    std::vector<placed_glyph> glyphs;
+    ivec2 size = {0, 0};
+};
 
 /*
 A wrapper for fonts, including some extra functionality such as "font::change_size(int new_size)"
@@ -10,11 +42,47 @@ aswell as font::load_system_font(string font_name, int ptsize)
 struct font {
     private:
     //the size of the font
-    int f_size;
+    int f_size = 0;
     //the actual SDL font
     TTF_Font* sdl_font = nullptr;
     //the name of the original file for resizing purposes
     string file_name;
+    //set when the font was opened from memory (such as an asset_archive), resizing reopens it from here instead of the file
+    const void* mem_data = nullptr;
+    size_t mem_size = 0;
+
+    //the glyph atlas, glyphs are rasterized the first time they are drawn and kept for the lifetime of the font
+    //glyphs are keyed by character, point size and whether they are anti-aliased, so resizing does not throw anything away
+    //pages are never moved or resized, so a glyph quad that is still waiting in a batch never points at a dead texture
+    static constexpr int ATLAS_PAGE_SIZE = 512;
+    SDL_Renderer* atlas_renderer = nullptr;
+    std::vector<atlas_page> atlas_pages;
+    unordered_map<uint64_t, atlas_glyph> atlas_glyphs;
+    //bumped whenever the atlas is thrown away, anything holding on to page indices has to lay its text out again
+    int atlas_generation = 0;
+    //flushes the batch of the renderer that last queued glyphs from the atlas, so clearing it never leaves quads on dead pages
+    //weak so a font that outlives the renderer doesnt call into it
+    std::weak_ptr<std::function<void()>> atlas_batch_flush;
+
+    static uint64_t glyph_key(int size, Uint16 ch, bool aa) {
+        return (static_cast<uint64_t>(size) << 32) | (static_cast<uint64_t>(aa) << 16) | ch;
+    }
+
+    void add_atlas_page(int w, int h) {
+        //creates a new empty page, static textures start out undefined so it gets cleared to transparent
+        SDL_Texture* tex = SDL_CreateTexture(atlas_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, w, h);
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        std::vector<Uint32> clear(static_cast<size_t>(w) * h, 0);
+        SDL_UpdateTexture(tex, nullptr, clear.data(), w * 4);
+
+        atlas_pages.push_back({tex, w, h, 0, 0, 0});
+    }
+
+    TTF_Font* reopen(int ptsize) {
+        //opens the same font again at another size, from memory if thats where it came from
+        if (mem_data != nullptr) return TTF_OpenFontRW(SDL_RWFromConstMem(mem_data, (int)mem_size), 1, ptsize);
+        return TTF_OpenFont(file_name.c_str(), ptsize);
+    }
 
     public:
 
@@ -37,17 +105,28 @@ struct font {
         sdl_font = fnt;
     }
 
+    font(const void* data, size_t size, int ptsize) {
+        //creates a font from a ttf file already in memory without copying it, the memory has to outlive the font
+        mem_data = data;
+        mem_size = size;
+        sdl_font = reopen(ptsize);
+        f_size = ptsize;
+    }
+
     font(const font&) = delete;
     font& operator=(const font&) = delete;
 
     font& operator = (font& other) {
         if (this != &other) {
             if (sdl_font != nullptr) TTF_CloseFont(sdl_font);
+            clear_atlas();
             
             //creates a new font from a ttf font utilizing SDL_TTF library
-            sdl_font = TTF_OpenFont(other.file_name.c_str(), other.f_size);
             f_size = other.f_size;
             this->file_name = other.file_name;
+            mem_data = other.mem_data;
+            mem_size = other.mem_size;
+            sdl_font = reopen(f_size);
 
         }
 
@@ -62,7 +141,7 @@ struct font {
     void change_size(int new_size) {
         //changes the size of the font, should not be called every frame because it is quite slow
         TTF_CloseFont(sdl_font);
-        sdl_font = TTF_OpenFont(file_name.c_str(), new_size);
+        sdl_font = reopen(new_size);
         f_size = new_size;
     }
 
@@ -76,7 +155,125 @@ struct font {
         return sdl_font;
     }
 
+    const atlas_glyph* get_glyph(SDL_Renderer* r, Uint16 ch, bool aa) {
+        /*
+        returns where a glyph lives in the atlas, rasterizing and uploading it first if this is the first time its drawn
+        glyphs are rendered in white so they can be tinted to any color when drawn
+        returns nullptr if the font cannot render the glyph
+        */
+        if (sdl_font == nullptr) return nullptr;
+
+        //the atlas belongs to one renderer, if a different one asks we start over
+        if (r != atlas_renderer) {
+            clear_atlas();
+            atlas_renderer = r;
+        }
+
+        uint64_t key = glyph_key(f_size, ch, aa);
+        auto found = atlas_glyphs.find(key);
+        if (found != atlas_glyphs.end()) return &found->second;
+
+        SDL_Surface* rendered = aa ? TTF_RenderGlyph_Blended(sdl_font, ch, {255, 255, 255, 255}) :
+                                     TTF_RenderGlyph_Solid(sdl_font, ch, {255, 255, 255, 255});
+        if (rendered == nullptr) return nullptr;
+        SDL_Surface* glyph = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(rendered);
+        if (glyph == nullptr) return nullptr;
+
+        //find a spot on the last page, start a new shelf or a new page if it doesnt fit
+        //a 1 pixel gap is left between glyphs so linear filtering doesnt bleed neighbours in
+        if (atlas_pages.empty()) add_atlas_page(std::max(ATLAS_PAGE_SIZE, glyph->w), std::max(ATLAS_PAGE_SIZE, glyph->h));
+        atlas_page* page = &atlas_pages.back();
+        if (page->shelf_x + glyph->w > page->w) {
+            page->shelf_y += page->shelf_h + 1;
+            page->shelf_x = 0;
+            page->shelf_h = 0;
+        }
+        if (page->shelf_y + glyph->h > page->h || glyph->w > page->w) {
+            add_atlas_page(std::max(ATLAS_PAGE_SIZE, glyph->w), std::max(ATLAS_PAGE_SIZE, glyph->h));
+            page = &atlas_pages.back();
+        }
+
+        SDL_Rect src = {page->shelf_x, page->shelf_y, glyph->w, glyph->h};
+        SDL_UpdateTexture(page->tex, &src, glyph->pixels, glyph->pitch);
+        SDL_FreeSurface(glyph);
+
+        page->shelf_x += src.w + 1;
+        page->shelf_h = std::max(page->shelf_h, src.h);
+
+        atlas_glyph& g = atlas_glyphs[key];
+        g = {static_cast<int>(atlas_pages.size()) - 1, src};
+        return &g;
+    }
+
+    void layout_text(SDL_Renderer* r, const string& text, bool aa, text_layout& out) {
+        /*
+        lays out a line of text into <out>, placing every glyph from the atlas and kerning them like SDL_ttf does
+        the size is the same as the surface TTF_RenderText_* would have made, empty text has a size of {0, 0}
+        */
+        out.glyphs.clear();
+        out.size = {0, 0};
+        if (text.empty() || sdl_font == nullptr) return;
+        if (TTF_SizeText(sdl_font, text.c_str(), &out.size.x, &out.size.y) != 0) {
+            out.size = {0, 0};
+            return;
+        }
+
+        int pen_x = 0;
+        Uint16 prev = 0;
+        for (unsigned char c: text) {
+            Uint16 ch = c;
+            if (prev != 0) pen_x += TTF_GetFontKerningSizeGlyphs(sdl_font, prev, ch);
+            prev = ch;
+
+            const atlas_glyph* g = get_glyph(r, ch, aa);
+            if (g != nullptr) out.glyphs.push_back({g->page, g->src, pen_x});
+
+            int advance = 0;
+            TTF_GlyphMetrics(sdl_font, ch, nullptr, nullptr, nullptr, nullptr, &advance);
+            pen_x += advance;
+        }
+    }
+
+    SDL_Texture* get_atlas_page(int page) {
+        //returns the texture of one of the atlas pages
+        return atlas_pages[page].tex;
+    }
+
+    ivec2 get_atlas_page_size(int page) {
+        //returns the size in pixels of one of the atlas pages
+        return {atlas_pages[page].w, atlas_pages[page].h};
+    }
+
+    int get_atlas_generation() {
+        //returns a number that changes every time the atlas is cleared
+        return atlas_generation;
+    }
+
+    int get_atlas_page_count() {
+        //returns how many atlas pages have been created so far
+        return static_cast<int>(atlas_pages.size());
+    }
+
+    void set_atlas_batch(const std::shared_ptr<std::function<void()>>& flush) {
+        //called by renderer::queue_text, <flush> is run before the atlas pages are destroyed
+        atlas_batch_flush = flush;
+    }
+
+    void clear_atlas() {
+        //destroys every atlas page, glyphs will be rasterized again the next time they are drawn
+        if (std::shared_ptr<std::function<void()>> flush = atlas_batch_flush.lock()) (*flush)();
+        for (atlas_page& p: atlas_pages) {
+            SDL_DestroyTexture(p.tex);
+        }
+        atlas_pages.clear();
+        atlas_glyphs.clear();
+        atlas_renderer = nullptr;
+        atlas_generation++;
+    }
+
     ~font() {
+        clear_atlas();
         if (sdl_font != nullptr) TTF_CloseFont(sdl_font);
     }
 
@@ -0,0 +1,187 @@
+#ifndef FRAME_PIPELINE
+#define FRAME_PIPELINE
+
+#include "renderer.hpp"
+#include "render_snapshot.hpp"
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+
+//how the last frame run through a frame_pipeline spent its time
+struct pipeline_stats {
+    //the whole frame, from frame_pipeline::frame being called to it returning
+    seconds_t frame_time = 0;
+    //the simulate callback, on whichever thread ran it
+    seconds_t sim_time = 0;
+    //drawing the snapshot and presenting, on the calling thread
+    seconds_t render_time = 0;
+    //how long the calling thread waited for the simulation after presenting
+    seconds_t wait_time = 0;
+    //how long the simulation and rendering ran at the same time, 0 when not pipelined
+    seconds_t overlap = 0;
+
+    double get_overlap_ratio() const {
+        //overlap as a share of the shorter of the two, 1 means the shorter one was completely hidden behind the longer one
+        seconds_t shorter = std::min(sim_time, render_time);
+        return shorter > 0 ? static_cast<double>(overlap / shorter) : 0.0;
+    }
+};
+
+
+/*
+runs the simulation of the next frame on a job_system worker while the calling thread draws and presents the last one
+
+    job_system jobs;
+    frame_pipeline pipeline(rend, jobs);
+    while (running) {
+        input.pump();
+        pipeline.frame([&](render_snapshot& snap) {
+            //runs on a worker, no SDL calls in here
+            while (clk.tick()) {
+                sprites.update(clk.get_dt());
+                emitter.update(clk.get_dt());
+            }
+            sprites.capture(snap, lvl.get_scroll());
+            emitter.capture(snap);
+            hud.capture(snap);
+        }, [&](render_snapshot& snap) {
+            //runs on the calling thread, with the snapshot the simulation filled in last frame
+            rend.fill(BLACK);
+            snap.draw(rend);
+        });
+    }
+
+only what the capture functions put in the snapshot is drawn, sprite subclasses that override draw but not capture
+(prop does both) draw nothing at all in a pipelined frame, so give them a capture before moving them over
+the two snapshots are swapped every frame, so what is on screen is always one simulation step behind the newest one
+the simulate callback cant touch SDL, and anything owning a texture has to be created and destroyed outside of it,
+a snapshot being drawn may still be using that texture
+capturing a UI element rebuilds the draw list a canvas caches, and canvas::element_at refreshes its hit index from the same elements,
+so UI captured in simulate must not be touched from draw (no canvas::element_at or canvas::draw), use it between frames instead
+input is read on the calling thread before the frame, so pump before calling frame_pipeline::frame
+
+with pipelining off the same callbacks run back to back on the calling thread, which makes comparing the two easy
+*/
+class frame_pipeline {
+    private:
+    renderer* rend;
+    job_system* jobs;
+    render_snapshot snapshots[2];
+    //the snapshot being drawn, the other one is being filled in
+    int front = 0;
+    //whether the front snapshot has been filled in yet
+    bool primed = false;
+    bool pipelined = true;
+    unsigned long long frame_count = 0;
+
+    pipeline_stats last_stats;
+
+    static int64_t now_ns() {
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    static seconds_t to_seconds(int64_t ns) {
+        return ns / 1000000000.0L;
+    }
+
+    template<typename S>
+    void simulate_into(S& simulate, render_snapshot& snap, int64_t& start, int64_t& end) {
+        CELERIT_PROFILE_ZONE("frame_pipeline::simulate");
+        start = now_ns();
+        snap.clear();
+        simulate(snap);
+        snap.frame = ++frame_count;
+        end = now_ns();
+    }
+
+    template<typename D>
+    void render(D& draw, render_snapshot& snap, int64_t& start, int64_t& end) {
+        CELERIT_PROFILE_ZONE("frame_pipeline::render");
+        start = now_ns();
+        draw(snap);
+        rend->update();
+        end = now_ns();
+    }
+
+    public:
+
+    frame_pipeline(renderer& r, job_system& j) {
+        rend = &r;
+        jobs = &j;
+    }
+
+    void set_pipelined(bool b) {
+        //turns pipelining on or off, turning it on makes the next frame simulate twice so it has a snapshot to draw
+        if (b != pipelined) primed = false;
+        pipelined = b;
+    }
+
+    bool is_pipelined() const {
+        return pipelined;
+    }
+
+    template<typename S, typename D>
+    void frame(S&& simulate, D&& draw) {
+        /*
+        runs one frame, simulate(render_snapshot&) fills in a snapshot and draw(render_snapshot&) draws one
+        the renderer is presented after draw returns
+        */
+        int64_t frame_start = now_ns();
+        int64_t sim_start = 0, sim_end = 0, render_start = 0, render_end = 0;
+
+        if (!pipelined) {
+            render_snapshot& snap = snapshots[front];
+            simulate_into(simulate, snap, sim_start, sim_end);
+            render(draw, snap, render_start, render_end);
+
+            last_stats.frame_time = to_seconds(now_ns() - frame_start);
+            last_stats.sim_time = to_seconds(sim_end - sim_start);
+            last_stats.render_time = to_seconds(render_end - render_start);
+            last_stats.wait_time = 0;
+            last_stats.overlap = 0;
+            return;
+        }
+
+        if (!primed) {
+            //the first pipelined frame has nothing to draw yet, so it simulates one snapshot up front
+            simulate_into(simulate, snapshots[front], sim_start, sim_end);
+            primed = true;
+        }
+
+        //the next frame is simulated into the back snapshot while the front one is drawn
+        render_snapshot& back = snapshots[1 - front];
+        job_counter sim_done;
+        jobs->submit([&] { simulate_into(simulate, back, sim_start, sim_end); }, &sim_done);
+
+        render(draw, snapshots[front], render_start, render_end);
+
+        int64_t wait_start = now_ns();
+        jobs->wait(sim_done);
+        int64_t wait_end = now_ns();
+        front = 1 - front;
+
+        last_stats.frame_time = to_seconds(wait_end - frame_start);
+        last_stats.sim_time = to_seconds(sim_end - sim_start);
+        last_stats.render_time = to_seconds(render_end - render_start);
+        last_stats.wait_time = to_seconds(wait_end - wait_start);
+        int64_t overlap = std::min(sim_end, render_end) - std::max(sim_start, render_start);
+        last_stats.overlap = to_seconds(std::max<int64_t>(0, overlap));
+    }
+
+    const pipeline_stats& get_last_stats() const {
+        return last_stats;
+    }
+
+    render_snapshot& get_front_snapshot() {
+        //the snapshot that was drawn last frame (or will be drawn next frame, when pipelined)
+        return snapshots[front];
+    }
+
+    unsigned long long get_frame_count() const {
+        //how many snapshots have been simulated
+        return frame_count;
+    }
+};
+
+
+#endif
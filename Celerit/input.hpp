@@ -2,7 +2,12 @@
 #define INPUT
 
 #include "util.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <fstream>
 #include <functional>
+#include <type_traits>
 
 using std::function, std::vector;
 
@@ -20,21 +25,368 @@ union mouse_buttons {
     };
 };
 
+/*
+functions bound to keys, kept in one flat array sorted by scancode so dispatching a key is a lookup and a loop, no hashing
+binding is the slow part (everything after the new bind shifts over), which is fine since it happens rarely
+*/
+class key_bind_table {
+    private:
+    vector<SDL_Scancode> keys;
+    vector<function<void()>> funcs;
+    //where each scancodes binds start in funcs and how many there are
+    uint32_t first[SDL_NUM_SCANCODES] = {};
+    uint32_t count[SDL_NUM_SCANCODES] = {};
+
+    public:
+
+    void add(SDL_Scancode sc, function<void()> func) {
+        //adds a bind after any the scancode already has, so binds still run in the order they were made
+        size_t at = std::upper_bound(keys.begin(), keys.end(), sc) - keys.begin();
+        keys.insert(keys.begin() + at, sc);
+        funcs.insert(funcs.begin() + at, std::move(func));
+
+        count[sc]++;
+        first[sc] = static_cast<uint32_t>(at - (count[sc] - 1));
+        for (int i = sc + 1; i < SDL_NUM_SCANCODES; i++) {
+            first[i]++;
+        }
+    }
+
+    void dispatch(SDL_Scancode sc) {
+        //runs every function bound to the scancode, binding more keys from inside a bound function isnt allowed
+        if (sc < 0 || sc >= SDL_NUM_SCANCODES) return;
+        for (uint32_t i = first[sc], end = first[sc] + count[sc]; i < end; i++) {
+            funcs[i]();
+        }
+    }
+
+    void clear() {
+        keys.clear();
+        funcs.clear();
+        std::fill(first, first + SDL_NUM_SCANCODES, 0);
+        std::fill(count, count + SDL_NUM_SCANCODES, 0);
+    }
+};
+
+
+/*
+The format input recordings are saved in (see input::start_recording), numbers are little endian
+
+    header      8 magic bytes then a uint32 version
+    records     uint32 frame, uint32 SDL timestamp, uint8 kind, then the kinds payload (see input_log::write_event)
+    end         a record of kind END whose frame is the number of frames recorded
+
+only events input cares about are kept, and only the fields it reads, so a log is a lot smaller than raw SDL_Events
+*/
+namespace input_log {
+    constexpr char MAGIC[8] = {'C', 'L', 'R', 'I', 'N', 'P', 'U', 'T'};
+    constexpr uint32_t VERSION = 1;
+
+    enum kind : uint8_t {
+        KEY_DOWN = 1,
+        KEY_UP,
+        MOUSE_MOTION,
+        MOUSE_DOWN,
+        MOUSE_UP,
+        MOUSE_WHEEL,
+        TEXT,
+        WINDOW,
+        QUIT,
+        END = 0xFF
+    };
+
+    template<typename T>
+    inline void put(std::ostream& os, T v) {
+        //writes an integer lowest byte first, signed ones as the unsigned number with the same bits
+        using U = std::make_unsigned_t<T>;
+        U u = static_cast<U>(v);
+        for (size_t i = 0; i < sizeof(T); i++) os.put(static_cast<char>((u >> (8 * i)) & 0xFF));
+    }
+
+    template<typename T>
+    inline bool get(std::istream& is, T& v) {
+        //reads an integer written by put, v is only changed if all of its bytes were there
+        using U = std::make_unsigned_t<T>;
+        unsigned char bytes[sizeof(T)];
+        if (!is.read(reinterpret_cast<char*>(bytes), sizeof(T))) return false;
+        U u = 0;
+        for (size_t i = 0; i < sizeof(T); i++) u |= static_cast<U>(static_cast<U>(bytes[i]) << (8 * i));
+        v = static_cast<T>(u);
+        return true;
+    }
+
+    inline void write_event(std::ostream& os, uint32_t frame, const SDL_Event& e) {
+        //writes one event, events of types input doesnt use are skipped
+        kind k;
+        switch (e.type) {
+            case SDL_KEYDOWN: k = KEY_DOWN; break;
+            case SDL_KEYUP: k = KEY_UP; break;
+            case SDL_MOUSEMOTION: k = MOUSE_MOTION; break;
+            case SDL_MOUSEBUTTONDOWN: k = MOUSE_DOWN; break;
+            case SDL_MOUSEBUTTONUP: k = MOUSE_UP; break;
+            case SDL_MOUSEWHEEL: k = MOUSE_WHEEL; break;
+            case SDL_TEXTINPUT: k = TEXT; break;
+            case SDL_WINDOWEVENT: k = WINDOW; break;
+            case SDL_QUIT: k = QUIT; break;
+            default: return;
+        }
+        put<uint32_t>(os, frame);
+        put<uint32_t>(os, e.key.timestamp);
+        put<uint8_t>(os, k);
+
+        switch (k) {
+            case KEY_DOWN:
+            case KEY_UP:
+                put<uint16_t>(os, static_cast<uint16_t>(e.key.keysym.scancode));
+                put<int32_t>(os, e.key.keysym.sym);
+                put<uint16_t>(os, e.key.keysym.mod);
+                put<uint8_t>(os, e.key.repeat);
+                break;
+            case MOUSE_MOTION:
+                put<uint32_t>(os, e.motion.state);
+                put<int32_t>(os, e.motion.x);
+                put<int32_t>(os, e.motion.y);
+                put<int32_t>(os, e.motion.xrel);
+                put<int32_t>(os, e.motion.yrel);
+                break;
+            case MOUSE_DOWN:
+            case MOUSE_UP:
+                put<uint8_t>(os, e.button.button);
+                put<uint8_t>(os, e.button.clicks);
+                put<int32_t>(os, e.button.x);
+                put<int32_t>(os, e.button.y);
+                break;
+            case MOUSE_WHEEL:
+                put<int32_t>(os, e.wheel.x);
+                put<int32_t>(os, e.wheel.y);
+                break;
+            case TEXT: {
+                uint8_t length = static_cast<uint8_t>(strnlen(e.text.text, sizeof(e.text.text)));
+                put<uint8_t>(os, length);
+                os.write(e.text.text, length);
+                break;
+            }
+            case WINDOW:
+                put<uint8_t>(os, e.window.event);
+                put<int32_t>(os, e.window.data1);
+                put<int32_t>(os, e.window.data2);
+                break;
+            default:
+                break;
+        }
+    }
+
+    inline bool read_event(std::istream& is, uint32_t& frame, kind& k, SDL_Event& e) {
+        //reads one record back into an SDL_Event, returns false at the end of the file or if the record is broken
+        uint32_t timestamp;
+        uint8_t raw_kind;
+        if (!get(is, frame) || !get(is, timestamp) || !get(is, raw_kind)) return false;
+        k = static_cast<kind>(raw_kind);
+        memset(&e, 0, sizeof(e));
+
+        switch (k) {
+            case KEY_DOWN:
+            case KEY_UP: {
+                uint16_t sc, mod;
+                int32_t sym;
+                uint8_t repeat;
+                if (!get(is, sc) || !get(is, sym) || !get(is, mod) || !get(is, repeat)) return false;
+                e.type = k == KEY_DOWN ? SDL_KEYDOWN : SDL_KEYUP;
+                e.key.state = k == KEY_DOWN ? SDL_PRESSED : SDL_RELEASED;
+                e.key.keysym.scancode = static_cast<SDL_Scancode>(sc);
+                e.key.keysym.sym = sym;
+                e.key.keysym.mod = mod;
+                e.key.repeat = repeat;
+                break;
+            }
+            case MOUSE_MOTION:
+                e.type = SDL_MOUSEMOTION;
+                if (!get(is, e.motion.state) || !get(is, e.motion.x) || !get(is, e.motion.y) ||
+                    !get(is, e.motion.xrel) || !get(is, e.motion.yrel)) return false;
+                break;
+            case MOUSE_DOWN:
+            case MOUSE_UP:
+                e.type = k == MOUSE_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                e.button.state = k == MOUSE_DOWN ? SDL_PRESSED : SDL_RELEASED;
+                if (!get(is, e.button.button) || !get(is, e.button.clicks) || !get(is, e.button.x) || !get(is, e.button.y)) return false;
+                break;
+            case MOUSE_WHEEL:
+                e.type = SDL_MOUSEWHEEL;
+                if (!get(is, e.wheel.x) || !get(is, e.wheel.y)) return false;
+                break;
+            case TEXT: {
+                e.type = SDL_TEXTINPUT;
+                uint8_t length;
+                if (!get(is, length) || length >= sizeof(e.text.text)) return false;
+                if (!is.read(e.text.text, length)) return false;
+                break;
+            }
+            case WINDOW:
+                e.type = SDL_WINDOWEVENT;
+                if (!get(is, e.window.event) || !get(is, e.window.data1) || !get(is, e.window.data2)) return false;
+                break;
+            case QUIT:
+                e.type = SDL_QUIT;
+                break;
+            case END:
+                break;
+            default:
+                return false;
+        }
+        //the timestamp is in the same place for every event type
+        e.key.timestamp = timestamp;
+        return true;
+    }
+}
+
+
+/*
+the keyboard as input::get_keyboard returns it, indexed by keycode (SDLK enums) like the map it used to be
+a view of the inputs state, so it always shows the current frame
+*/
+class keyboard_state {
+    private:
+    const std::bitset<SDL_NUM_SCANCODES>* keys;
+
+    public:
+    keyboard_state(const std::bitset<SDL_NUM_SCANCODES>& k) {
+        keys = &k;
+    }
+
+    bool at(int sdl_keycode) const {
+        //whether the key is held, keys with no scancode on the current keyboard layout never are
+        SDL_Scancode sc = SDL_GetScancodeFromKey(sdl_keycode);
+        return sc > SDL_SCANCODE_UNKNOWN && sc < SDL_NUM_SCANCODES && keys->test(sc);
+    }
+
+    bool operator[](int sdl_keycode) const {
+        return at(sdl_keycode);
+    }
+};
+
+
 /*
 a class for managing input
 */
 class input {
     private:
-    //a map of all the keyboard keys
-    //all maps are accesed through the SDLK enums
-    unordered_map<int, bool> keyboard;
-    //mapped functions for when a button is pressed
-    unordered_map<int, vector<function<void()>>> button_down_binds;
-    //mapped fuctios for when a button is released
-    unordered_map<int, vector<function<void()>>> button_up_binds;
+    //the keyboard, one bit per scancode for whether its held now and whether it was held at the end of the last frame
+    std::bitset<SDL_NUM_SCANCODES> keys_down;
+    std::bitset<SDL_NUM_SCANCODES> keys_prev;
+    //keys that went down or up since input::new_frame, so a tap inside a single frame isnt missed
+    std::bitset<SDL_NUM_SCANCODES> keys_pressed;
+    std::bitset<SDL_NUM_SCANCODES> keys_released;
+    //bound functions for when a key is pressed and released
+    key_bind_table button_down_binds;
+    key_bind_table button_up_binds;
     //mouse things
     mouse_buttons mouse;
     ivec2 mouse_pos = {-1, -1};
+    ivec2 mouse_wheel = {0, 0};
+
+    //every event input::pump took off the queue, in a ring so a flood of events cant grow it forever
+    //events are numbered by how many came before them, the ring holds the last EVENT_RING_SIZE of them
+    static constexpr uint32_t EVENT_RING_SIZE = 1024;
+    static constexpr int PEEP_BATCH = 64;
+    vector<SDL_Event> event_ring = vector<SDL_Event>(EVENT_RING_SIZE);
+    uint32_t events_written = 0;
+    uint32_t frame_first_event = 0;
+    uint32_t frame_dropped_events = 0;
+    //merge runs of mouse motion into one event, so a fast mouse doesnt fill the frame with hundreds of them
+    bool coalesce_motion = true;
+
+    //frames pumped so far, recordings and replays count frames from when they started
+    uint32_t frame_index = 0;
+    std::ofstream recording;
+    uint32_t recording_start = 0;
+    //a loaded recording, fed back in by input::pump instead of the real events
+    struct replay_event {
+        uint32_t frame;
+        SDL_Event e;
+    };
+    vector<replay_event> replay;
+    size_t replay_cursor = 0;
+    uint32_t replay_start = 0;
+    uint32_t replay_length = 0;
+    bool replaying = false;
+
+    //text typed and window changes seen this frame
+    string frame_text;
+    bool quit = false;
+    bool resized = false;
+    ivec2 window_size = {0, 0};
+    bool focused = true;
+
+    void handle_event(const SDL_Event& e) {
+        //updates the input state from one event
+        switch (e.type) {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP: {
+                SDL_Scancode sc = e.key.keysym.scancode;
+                if (sc < 0 || sc >= SDL_NUM_SCANCODES) return;
+
+                if (e.type == SDL_KEYDOWN) {
+                    //key repeats still run binds, but they arent a new press
+                    if (!e.key.repeat) keys_pressed.set(sc);
+                    keys_down.set(sc);
+                    button_down_binds.dispatch(sc);
+                } else {
+                    keys_released.set(sc);
+                    keys_down.reset(sc);
+                    button_up_binds.dispatch(sc);
+                }
+                break;
+            }
+            case SDL_MOUSEMOTION:
+                mouse_pos = {e.motion.x, e.motion.y};
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+                mouse.mask |= SDL_BUTTON(e.button.button);
+                mouse_pos = {e.button.x, e.button.y};
+                break;
+            case SDL_MOUSEBUTTONUP:
+                mouse.mask &= ~SDL_BUTTON(e.button.button);
+                mouse_pos = {e.button.x, e.button.y};
+                break;
+            case SDL_MOUSEWHEEL:
+                mouse_wheel.x += e.wheel.x;
+                mouse_wheel.y += e.wheel.y;
+                break;
+            case SDL_TEXTINPUT:
+                frame_text += e.text.text;
+                break;
+            case SDL_WINDOWEVENT:
+                if (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED || e.window.event == SDL_WINDOWEVENT_RESIZED) {
+                    resized = true;
+                    window_size = {e.window.data1, e.window.data2};
+                } else if (e.window.event == SDL_WINDOWEVENT_FOCUS_GAINED) {
+                    focused = true;
+                } else if (e.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
+                    focused = false;
+                }
+                break;
+            case SDL_QUIT:
+                quit = true;
+                break;
+        }
+    }
+
+    void store_event(const SDL_Event& e) {
+        //adds an event to the ring, or folds it into the last one if both are mouse motion
+        if (coalesce_motion && e.type == SDL_MOUSEMOTION && events_written > frame_first_event) {
+            SDL_Event& last = event_ring[(events_written - 1) % EVENT_RING_SIZE];
+            if (last.type == SDL_MOUSEMOTION && last.motion.which == e.motion.which && last.motion.windowID == e.motion.windowID) {
+                int xrel = last.motion.xrel + e.motion.xrel;
+                int yrel = last.motion.yrel + e.motion.yrel;
+                last = e;
+                last.motion.xrel = xrel;
+                last.motion.yrel = yrel;
+                return;
+            }
+        }
+        event_ring[events_written % EVENT_RING_SIZE] = e;
+        events_written++;
+    }
 
     public:
     input() {
@@ -45,55 +397,244 @@ class input {
 
     void bind_keydown(int sdl_keycode, const function<void()> func) {
         //bind a function that returns nothing (but you can use lamda refrences to get around this) to a keyboard key being pressed
-        
-        //if we dont find the button function vector, we make one
-        if (button_down_binds.find(sdl_keycode) == button_down_binds.end()) {
-            button_down_binds[sdl_keycode] = vector<function<void()>>();
-        }
-        //add the function the the SDL keycode
-        button_down_binds[sdl_keycode].push_back(func);
+        //keys are stored by scancode, so the keycode is turned into one for the current keyboard layout
+        button_down_binds.add(SDL_GetScancodeFromKey(sdl_keycode), func);
     }
     void bind_keyup(int sdl_keycode, const function<void()> func) {
         //bind a function that returns nothing (but you can use lamda refrences to get around this) to a keyboard key being released 
+        button_up_binds.add(SDL_GetScancodeFromKey(sdl_keycode), func);
+    }
+
+    void bind_scancode_down(SDL_Scancode sc, const function<void()> func) {
+        //like input::bind_keydown but for a physical key, so the bind doesnt move with the keyboard layout
+        button_down_binds.add(sc, func);
+    }
+
+    void bind_scancode_up(SDL_Scancode sc, const function<void()> func) {
+        button_up_binds.add(sc, func);
+    }
+
+    void new_frame() {
+        //call once at the start of every frame before handling its events, so pressed/released_this_frame only see this frame
+        //input::pump calls this itself
+        keys_prev = keys_down;
+        keys_pressed.reset();
+        keys_released.reset();
+        mouse_wheel = {0, 0};
+        frame_text.clear();
+        resized = false;
+        frame_first_event = events_written;
+        frame_dropped_events = 0;
+    }
 
-        //the comments would be the same here as up there in input::bind_keydown
-        if (button_up_binds.find(sdl_keycode) == button_up_binds.end()) {
-            button_up_binds[sdl_keycode] = vector<function<void()>>();
+    int pump() {
+        /*
+        takes every waiting event off the SDL queue in batches and updates the input state from them, call once a frame
+        instead of polling events yourself, the events stay available through input::get_event until the next pump
+        returns the number of events taken off the queue
+        */
+        new_frame();
+        frame_index++;
+        SDL_PumpEvents();
+
+        SDL_Event batch[PEEP_BATCH];
+        int total = 0;
+        while (true) {
+            int n = SDL_PeepEvents(batch, PEEP_BATCH, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+            if (n <= 0) break;
+            //while replaying the real events are still drained so the queue doesnt fill up, but only the recording is used
+            if (!replaying) {
+                for (int i = 0; i < n; i++) {
+                    if (recording.is_open()) input_log::write_event(recording, frame_index - recording_start, batch[i]);
+                    handle_event(batch[i]);
+                    store_event(batch[i]);
+                }
+            }
+            total += n;
+            if (n < PEEP_BATCH) break;
         }
-        button_up_binds[sdl_keycode].push_back(func);
+
+        if (replaying) {
+            total = 0;
+            uint32_t frame = frame_index - replay_start;
+            while (replay_cursor < replay.size() && replay[replay_cursor].frame <= frame) {
+                handle_event(replay[replay_cursor].e);
+                store_event(replay[replay_cursor].e);
+                replay_cursor++;
+                total++;
+            }
+            if (frame >= replay_length) replaying = false;
+        }
+
+        uint32_t frame_events = events_written - frame_first_event;
+        if (frame_events > EVENT_RING_SIZE) frame_dropped_events = frame_events - EVENT_RING_SIZE;
+        return total;
     }
 
     void update(SDL_Event& e) {
-        //should be called every frame with an SDL_Event passed to it
+        //should be called every frame with an SDL_Event passed to it, input::pump does this for the whole queue at once
         
 
         //update the mask
         mouse.mask = SDL_GetMouseState(&mouse_pos.x, &mouse_pos.y);
-        if (e.type == SDL_KEYDOWN) {
-            //check and update keypresses
-            keyboard[e.key.keysym.sym] = true;
-            if (button_down_binds.find(e.key.keysym.sym) != button_down_binds.end()) {
-                for (function<void()> i: button_down_binds[e.key.keysym.sym]) {
-                    //run all functions in the mapped keybinds
-                    i();
-                }
-            }
-        } else if (e.type == SDL_KEYUP) {
-            //same thing for key releases
-            keyboard[e.key.keysym.sym] = false;
-            if (button_up_binds.find(e.key.keysym.sym) != button_up_binds.end()) {
-                for (function<void()> i: button_up_binds[e.key.keysym.sym]) {
-                    i();
-                }
+        handle_event(e);
+    }
+
+    int get_event_count() const {
+        //the number of events the last input::pump kept, after mouse motion was merged
+        return static_cast<int>(events_written - frame_first_event - frame_dropped_events);
+    }
+
+    const SDL_Event& get_event(int i) const {
+        //the i-th event of the last input::pump, in the order they happened
+        return event_ring[(frame_first_event + frame_dropped_events + static_cast<uint32_t>(i)) % EVENT_RING_SIZE];
+    }
+
+    int get_dropped_event_count() const {
+        //events that happened in the last pump but fell out of the ring (they still updated the input state)
+        return static_cast<int>(frame_dropped_events);
+    }
+
+    void start_recording(const string& path) {
+        //starts writing every event input::pump sees to a log at path, the next pump is frame 1 of the recording
+        stop_recording();
+        recording.open(path, std::ios::binary | std::ios::trunc);
+        if (!recording) {
+            cerr << "Error: could not open input recording " << path << "\n";
+            exit(-1);
+        }
+        recording.write(input_log::MAGIC, sizeof(input_log::MAGIC));
+        input_log::put<uint32_t>(recording, input_log::VERSION);
+        recording_start = frame_index;
+    }
+
+    void stop_recording() {
+        //finishes the log, called by the destructor too
+        if (!recording.is_open()) return;
+        input_log::put<uint32_t>(recording, frame_index - recording_start);
+        input_log::put<uint32_t>(recording, 0);
+        input_log::put<uint8_t>(recording, input_log::END);
+        recording.close();
+    }
+
+    bool is_recording() const {
+        return recording.is_open();
+    }
+
+    void start_replay(const string& path) {
+        /*
+        loads a recording and plays it back through input::pump, which ignores real events until the replay finishes
+        binds run, and events arrive on the same frames they were recorded on, so with a fixed timestep (see sim_clock::advance)
+        the same session plays out the same way
+        */
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof(input_log::MAGIC)];
+        uint32_t version = 0;
+        if (!in || !in.read(magic, sizeof(magic)) || memcmp(magic, input_log::MAGIC, sizeof(magic)) != 0 ||
+            !input_log::get(in, version) || version != input_log::VERSION) {
+            cerr << "Error: " << path << " is not an input recording\n";
+            exit(-1);
+        }
+
+        replay.clear();
+        replay_length = 0;
+        uint32_t frame;
+        input_log::kind k;
+        SDL_Event e;
+        while (input_log::read_event(in, frame, k, e)) {
+            if (k == input_log::END) {
+                replay_length = frame;
+                break;
             }
+            replay.push_back({frame, e});
         }
+        //a recording that wasnt stopped properly has no end record, so it ends with its last event
+        if (replay_length == 0 && !replay.empty()) replay_length = replay.back().frame;
+
+        replay_cursor = 0;
+        replay_start = frame_index;
+        replaying = true;
+    }
+
+    bool is_replaying() const {
+        //true until every frame of the replay has been pumped
+        return replaying;
+    }
+
+    uint32_t get_frame_index() const {
+        //the number of times input::pump has been called
+        return frame_index;
+    }
+
+    void set_mouse_motion_coalescing(bool b) {
+        coalesce_motion = b;
+    }
+
+    const string& get_text() const {
+        //text typed during the last pump, needs SDL_StartTextInput
+        return frame_text;
+    }
+
+    ivec2 get_mouse_wheel() const {
+        //how far the wheel scrolled during the last pump
+        return mouse_wheel;
+    }
+
+    bool quit_requested() const {
+        //whether the window was asked to close, stays set once it happens
+        return quit;
+    }
+
+    bool was_resized() const {
+        return resized;
+    }
+
+    ivec2 get_window_size() const {
+        //the last size the window was resized to, {0, 0} if it never was
+        return window_size;
+    }
+
+    bool has_focus() const {
+        return focused;
+    }
+
+    ~input() {
+        stop_recording();
     }
 
 
 
-    const unordered_map<int, bool>& get_keyboard() {
-        //get the keyboard state, specifically, get the internal map of SDLK enums to bools (a bool meaning that the key is pressed)
-        return keyboard;
+    bool is_down(SDL_Scancode sc) const {
+        //whether the key is being held right now
+        return keys_down.test(sc);
+    }
+
+    bool was_down(SDL_Scancode sc) const {
+        //whether the key was being held at the end of the last frame
+        return keys_prev.test(sc);
+    }
+
+    bool pressed_this_frame(SDL_Scancode sc) const {
+        return keys_pressed.test(sc);
+    }
+
+    bool released_this_frame(SDL_Scancode sc) const {
+        return keys_released.test(sc);
+    }
+
+    bool is_key_down(int sdl_keycode) const {
+        //input::is_down for a keycode (SDLK enums) rather than a scancode
+        return keys_down.test(SDL_GetScancodeFromKey(sdl_keycode));
+    }
+
+    keyboard_state get_keyboard() const {
+        //get the keyboard state, indexed by keycode (SDLK enums), true meaning that the key is pressed
+        return keyboard_state(keys_down);
+    }
+
+    const std::bitset<SDL_NUM_SCANCODES>& get_scancode_state() const {
+        //get the keyboard state, one bit per scancode (SDL_SCANCODE enums), a set bit meaning that the key is pressed
+        return keys_down;
     }
 
     mouse_buttons get_mouse() {
@@ -0,0 +1,387 @@
+#ifndef JOB_SYSTEM
+#define JOB_SYSTEM
+
+#include "util.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using std::vector;
+
+
+class job_system;
+
+/*
+counts the jobs submitted with it that havent finished yet, wait on it with job_system::wait
+jobs can also be held back until a counter is done, see job_system::submit_after
+a counter has to outlive every job it counts
+*/
+class job_counter {
+    friend class job_system;
+    private:
+    std::atomic<int> count{0};
+
+    public:
+    job_counter() {}
+    job_counter(const job_counter&) = delete;
+    job_counter& operator=(const job_counter&) = delete;
+
+    bool is_done() const {
+        return count.load(std::memory_order_acquire) == 0;
+    }
+
+    int get_pending() const {
+        return count.load(std::memory_order_acquire);
+    }
+};
+
+//one unit of work, jobs made by job_system::submit are deleted once they run, parallel_for keeps its own on the stack
+struct job {
+    std::function<void()> work;
+    job_counter* counter = nullptr;
+    bool heap_allocated = false;
+    //false when nothing can be waiting on counter with job_system::submit_after, so finishing can skip the lock
+    bool releases_dependents = true;
+};
+
+
+/*
+a fixed size work stealing deque (Chase and Lev), only the thread that owns it pushes and pops at the bottom,
+any thread can steal from the top
+the version here follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+*/
+class work_stealing_deque {
+    private:
+    static constexpr int64_t CAPACITY = 4096;
+    static constexpr int64_t MASK = CAPACITY - 1;
+
+    std::atomic<int64_t> top{0};
+    std::atomic<int64_t> bottom{0};
+    std::unique_ptr<std::atomic<job*>[]> buffer = std::unique_ptr<std::atomic<job*>[]>(new std::atomic<job*>[CAPACITY]);
+
+    public:
+
+    bool push(job* j) {
+        //owner only, returns false when full so the caller can run the job itself
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) return false;
+        buffer[b & MASK].store(j, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    job* pop() {
+        //owner only, takes the newest job
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            //empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        job* j = buffer[b & MASK].load(std::memory_order_relaxed);
+        if (t == b) {
+            //the last job, race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) j = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return j;
+    }
+
+    job* steal() {
+        //any thread, takes the oldest job, returns nullptr if its empty or another thread got there first
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        job* j = buffer[t & MASK].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+        return j;
+    }
+};
+
+
+/*
+A work stealing job scheduler, every worker thread has its own deque and steals from the others when it runs dry
+
+    job_system jobs;
+    job_counter done;
+    jobs.submit([&] { build_level(); }, &done);
+    jobs.submit([&] { load_sounds(); }, &done);
+    jobs.wait(done);
+
+    jobs.parallel_for(0, count, [&](int first, int last) {
+        for (int i = first; i < last; i++) things[i].update();
+    });
+
+threads that arent workers (like the main thread) submit into a shared queue, and waiting on a counter runs jobs
+instead of blocking, so the thread waiting on the work helps do it
+*/
+class job_system {
+    private:
+    vector<std::thread> workers;
+    //one deque per worker
+    vector<std::unique_ptr<work_stealing_deque>> deques;
+    //jobs from threads that arent workers
+    std::mutex shared_mutex;
+    std::deque<job*> shared_queue;
+    //checked before taking the lock, so idle threads dont fight over an empty queue
+    std::atomic<int> shared_size{0};
+
+    //sleeping workers wait on this, queued counts jobs waiting anywhere so they know when to wake up
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{0};
+    std::atomic<bool> stopping{false};
+
+    //jobs held back by job_system::submit_after, counters are only ever decremented under this lock when they can have any,
+    //so a counter cant finish between being checked and having a job parked on it
+    std::mutex dependency_mutex;
+    vector<std::pair<job_counter*, job*>> dependents;
+
+    struct thread_slot {
+        job_system* owner = nullptr;
+        int index = -1;
+    };
+
+    static thread_slot& this_thread() {
+        //which job_system and worker the calling thread belongs to, if any
+        thread_local thread_slot slot;
+        return slot;
+    }
+
+    int worker_index() {
+        thread_slot& slot = this_thread();
+        return slot.owner == this ? slot.index : -1;
+    }
+
+    void enqueue(job* j) {
+        //a worker pushes to its own deque, anything else goes to the shared queue
+        int index = worker_index();
+        if (index >= 0) {
+            if (!deques[index]->push(j)) {
+                //full, running it right away is always correct
+                execute(j);
+                return;
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(shared_mutex);
+            shared_queue.push_back(j);
+            shared_size.fetch_add(1, std::memory_order_release);
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        notify();
+    }
+
+    void notify() {
+        //taking the lock means a worker between checking for work and going to sleep cant miss this
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        wake.notify_one();
+    }
+
+    job* find_job(int index) {
+        //own deque first, then the shared queue, then steal from the other workers starting next to us
+        job* j = nullptr;
+        if (index >= 0) j = deques[index]->pop();
+
+        if (j == nullptr && shared_size.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(shared_mutex);
+            if (!shared_queue.empty()) {
+                j = shared_queue.front();
+                shared_queue.pop_front();
+                shared_size.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        int count = static_cast<int>(deques.size());
+        for (int k = 1; j == nullptr && k <= count; k++) {
+            int victim = (index + k + count) % count;
+            if (victim == index) continue;
+            j = deques[victim]->steal();
+        }
+
+        if (j != nullptr) queued.fetch_sub(1, std::memory_order_relaxed);
+        return j;
+    }
+
+    void execute(job* j) {
+        j->work();
+        job_counter* counter = j->counter;
+        bool releases = j->releases_dependents;
+        if (j->heap_allocated) delete j;
+        if (counter == nullptr) return;
+
+        if (!releases) {
+            counter->count.fetch_sub(1, std::memory_order_acq_rel);
+            return;
+        }
+        //the last job on a counter releases anything parked on it
+        //once the count hits 0 a waiting thread may destroy the counter, so after that only its address is used
+        vector<job*> ready;
+        {
+            std::lock_guard<std::mutex> lock(dependency_mutex);
+            if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                for (size_t i = 0; i < dependents.size();) {
+                    if (dependents[i].first == counter) {
+                        ready.push_back(dependents[i].second);
+                        dependents[i] = dependents.back();
+                        dependents.pop_back();
+                    } else {
+                        i++;
+                    }
+                }
+            }
+        }
+        for (job* r: ready) enqueue(r);
+    }
+
+    void worker_loop(int index) {
+        this_thread() = {this, index};
+        while (true) {
+            job* j = find_job(index);
+            if (j != nullptr) {
+                execute(j);
+                continue;
+            }
+
+            //a short spin before sleeping, jobs tend to come in bursts
+            bool found = false;
+            for (int spin = 0; spin < 64 && !found; spin++) {
+                std::this_thread::yield();
+                found = queued.load(std::memory_order_acquire) > 0;
+            }
+            if (found) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] { return queued.load(std::memory_order_acquire) > 0 || stopping.load(); });
+            if (stopping.load() && queued.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+    static int default_worker_count() {
+        //one thread per core, minus the thread that made the job system since it helps out while waiting
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        return std::max(1, cores - 1);
+    }
+
+    public:
+
+    job_system(int worker_count = default_worker_count()) {
+        //starts worker_count threads
+        worker_count = std::max(1, worker_count);
+        for (int i = 0; i < worker_count; i++) deques.push_back(std::make_unique<work_stealing_deque>());
+        for (int i = 0; i < worker_count; i++) workers.emplace_back([this, i] { worker_loop(i); });
+    }
+
+    job_system(const job_system&) = delete;
+    job_system& operator=(const job_system&) = delete;
+
+    int get_worker_count() const {
+        return static_cast<int>(workers.size());
+    }
+
+    void submit(std::function<void()> work, job_counter* counter = nullptr) {
+        //runs work on whichever thread gets to it first, counter (if any) counts it until it has run
+        if (counter != nullptr) counter->count.fetch_add(1, std::memory_order_relaxed);
+        enqueue(new job{std::move(work), counter, true});
+    }
+
+    void submit_after(job_counter& dependency, std::function<void()> work, job_counter* counter = nullptr) {
+        //like job_system::submit, but work doesnt start until every job on dependency has finished
+        //counter cant be dependency, the job would be waiting on itself
+        if (counter != nullptr) counter->count.fetch_add(1, std::memory_order_relaxed);
+        job* j = new job{std::move(work), counter, true};
+        {
+            std::lock_guard<std::mutex> lock(dependency_mutex);
+            if (!dependency.is_done()) {
+                dependents.push_back({&dependency, j});
+                return;
+            }
+        }
+        enqueue(j);
+    }
+
+    void wait(job_counter& counter) {
+        //runs jobs until every job on counter has finished, so waiting never leaves a thread idle while there is work
+        int index = worker_index();
+        while (!counter.is_done()) {
+            job* j = find_job(index);
+            if (j != nullptr) {
+                execute(j);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template<typename F>
+    void parallel_for(int begin, int end, F&& func, int chunk_size = 0) {
+        /*
+        calls func(first, last) on chunks of [begin, end) across the workers and waits for all of them
+        chunks dont overlap, so func can write to the elements in its range without locking
+        with chunk_size 0 the range is split into about 4 chunks per thread, which evens out chunks that take longer than others
+        */
+        int count = end - begin;
+        if (count <= 0) return;
+        if (chunk_size <= 0) chunk_size = std::max(1, count / ((get_worker_count() + 1) * 4));
+        int chunks = (count + chunk_size - 1) / chunk_size;
+        if (chunks == 1) {
+            func(begin, end);
+            return;
+        }
+
+        //the first chunk is kept for the calling thread, the rest are handed out
+        job_counter counter;
+        counter.count.store(chunks - 1, std::memory_order_relaxed);
+        vector<job> chunk_jobs(chunks - 1);
+        for (int c = 1; c < chunks; c++) {
+            int first = begin + c * chunk_size;
+            int last = std::min(end, first + chunk_size);
+            chunk_jobs[c - 1].work = [&func, first, last] { func(first, last); };
+            chunk_jobs[c - 1].counter = &counter;
+            chunk_jobs[c - 1].releases_dependents = false;
+        }
+
+        int index = worker_index();
+        if (index >= 0) {
+            for (job& j: chunk_jobs) enqueue(&j);
+        } else {
+            //one lock for the whole batch
+            {
+                std::lock_guard<std::mutex> lock(shared_mutex);
+                for (job& j: chunk_jobs) shared_queue.push_back(&j);
+                shared_size.fetch_add(chunks - 1, std::memory_order_release);
+            }
+            queued.fetch_add(chunks - 1, std::memory_order_release);
+            { std::lock_guard<std::mutex> lock(sleep_mutex); }
+            wake.notify_all();
+        }
+
+        func(begin, std::min(end, begin + chunk_size));
+        wait(counter);
+    }
+
+    ~job_system() {
+        //finishes every job that was queued, then stops the workers, jobs still held back by submit_after are dropped
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping.store(true);
+        }
+        wake.notify_all();
+        for (std::thread& t: workers) t.join();
+        for (std::pair<job_counter*, job*>& d: dependents) delete d.second;
+    }
+};
+
+
+#endif
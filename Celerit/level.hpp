@@ -3,6 +3,9 @@
 
 #include "CeleritObject.hpp"
 #include "renderer.hpp"
+#include "spatial_grid.hpp"
+#include "tilemap.hpp"
+#include <algorithm>
 #include <vector>
 #include "map"
 
@@ -22,6 +25,10 @@ class level : public CObject {
     renderer* rend;
     dvec2 scroll_vec;
     vector<rect*> collision_rects;
+    //broadphase over collision_rects, so collision checks only look at nearby rects
+    spatial_grid collision_grid;
+    //an optional tile layer, drawn with the levels scroll and used for collision
+    tilemap* tiles = nullptr;
     
 
     
@@ -86,8 +93,29 @@ class level : public CObject {
         2. When checking collision we want to make sure we dont check against the same rect
         so we can easily do so by checking if the memory addreses of the 2 rects are the same
         3. so that you know what youre adding to the level rather than taking a refrence and getting the pointer that way
+
+        if the rect moves later on, call level::update_collision so the level knows where it went
         */
         collision_rects.push_back(r);
+        collision_grid.insert(r);
+    }
+
+    void remove_collision(rect* r) {
+        //removes a rect from the levels collision
+        auto found = std::find(collision_rects.begin(), collision_rects.end(), r);
+        if (found == collision_rects.end()) return;
+        collision_rects.erase(found);
+        collision_grid.remove(r);
+    }
+
+    void update_collision(rect* r) {
+        //tells the level that a rect added with level::add_collision has moved or changed size, cheap if it didnt move far
+        collision_grid.update(r);
+    }
+
+    void set_collision_cell_size(int size) {
+        //sets the size of the cells collision is binned into, ideally around the size of a typical collider
+        collision_grid.set_cell_size(size);
     }
 
     const vector<rect*>& get_collision() {
@@ -96,14 +124,47 @@ class level : public CObject {
     }
 
 
+    void set_tilemap(tilemap* t) {
+        //sets the levels tile layer, solid tiles count as collision, pass nullptr to remove it
+        tiles = t;
+    }
+
+    tilemap* get_tilemap() {
+        return tiles;
+    }
+
+    void draw_tiles() {
+        //draws the tile layer (if there is one) with the levels scroll, call from level::draw
+        if (tiles != nullptr) tiles->draw(scroll_vec);
+    }
+
     bool is_colliding(rect& collision_rect) {
-        //checks if <collision_rect> is colliding with any collision in the level
-        for (rect* r: collision_rects) {
-            if (collide_rect(*r, collision_rect) && r != &collision_rect) {
-                return true;
-            }
-        }
-        return false;
+        //checks if <collision_rect> is colliding with any collision in the level, including solid tiles
+        CELERIT_PROFILE_ZONE("level::is_colliding");
+        if (tiles != nullptr && tiles->is_colliding(collision_rect)) return true;
+        return collision_grid.for_each_overlapping(collision_rect, [&collision_rect](rect* r) {
+            return r != &collision_rect;
+        });
+    }
+
+    vector<rect*> query_rect(rect area) {
+        //returns all the collision in the level that collides with area
+        vector<rect*> out;
+        query_rect(area, out);
+        return out;
+    }
+
+    void query_rect(rect area, vector<rect*>& out) {
+        //appends all the collision in the level that collides with area to out, so the vector can be reused
+        //rects from the tile layer are only good until its tiles next change
+        CELERIT_PROFILE_ZONE("level::query_rect");
+        collision_grid.query_rect(area, out);
+        if (tiles != nullptr) tiles->query_rect(area, out);
+    }
+
+    vector<rect*> query_point(ivec2 point) {
+        //returns all the collision in the level that contains the point
+        return query_rect(rect{{point.x, point.y, 0, 0}});
     }
 
 
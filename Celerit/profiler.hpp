@@ -0,0 +1,282 @@
+#ifndef PROFILER
+#define PROFILER
+
+#include "util.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using std::string;
+using std::vector;
+
+
+/*
+A lightweight scoped zone profiler, zones are timed with RAII markers and kept in a ring buffer per thread
+
+    profiler::set_enabled(true);
+    while (running) {
+        profiler::begin_frame();
+        {
+            CELERIT_PROFILE_ZONE("game update");
+            ...
+        }
+        profiler::end_frame();
+    }
+    profiler::write_chrome_trace("trace.json");//open in chrome://tracing or ui.perfetto.dev
+
+the engine marks its own hot spots (draw calls, particles, level collision, UI), see profiler_overlay for drawing the results
+while disabled a zone costs one relaxed atomic load, define CELERIT_NO_PROFILER to compile them out entirely
+*/
+namespace profiler {
+    //records kept per thread, older records are overwritten once a thread has made more than this many
+    constexpr size_t RING_SIZE = 16384;
+
+    //one finished zone, times are steady_clock ticks in nanoseconds
+    struct zone_record {
+        const char* name;
+        int64_t start;
+        int64_t end;
+        uint32_t depth;
+    };
+
+    //the total time spent in every zone with the same name over one frame
+    struct zone_summary {
+        const char* name;
+        int64_t total_ns;
+        int64_t max_ns;
+        uint32_t calls;
+        uint32_t depth;
+    };
+
+    inline int64_t now_ns() {
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*
+    the records one thread has made, only that thread writes to it
+    the write count is published after the record is stored, readers copy records and then check
+    the count again so anything overwritten while they were copying is thrown away
+    */
+    struct thread_buffer {
+        vector<zone_record> records = vector<zone_record>(RING_SIZE);
+        std::atomic<uint64_t> written{0};
+        uint32_t depth = 0;
+        uint32_t thread_id = 0;
+        //where profiler::end_frame got to, and where profiler::clear left off, both only touched under the registry lock
+        uint64_t summary_cursor = 0;
+        uint64_t cleared = 0;
+
+        void push(const zone_record& z) {
+            uint64_t w = written.load(std::memory_order_relaxed);
+            records[w % RING_SIZE] = z;
+            written.store(w + 1, std::memory_order_release);
+        }
+
+        template<typename F>
+        uint64_t read(uint64_t from, F&& func) {
+            //calls func on every record from index <from> on that is still in the ring, returns the index after the last one
+            //the oldest record in the ring is skipped, its slot is the one the owning thread writes next
+            uint64_t end = written.load(std::memory_order_acquire);
+            uint64_t begin = std::max(from, cleared);
+            if (end >= RING_SIZE) begin = std::max(begin, end - RING_SIZE + 1);
+            for (uint64_t i = begin; i < end; i++) {
+                zone_record z = records[i % RING_SIZE];
+                //the owning thread may have lapped us while we were copying, or be writing the slot right now
+                //(while record i + RING_SIZE is being written the count is still i + RING_SIZE)
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (written.load(std::memory_order_relaxed) - i >= RING_SIZE) continue;
+                func(z);
+            }
+            return end;
+        }
+    };
+
+    struct state {
+        std::atomic<bool> enabled{false};
+        std::mutex registry_mutex;
+        vector<std::shared_ptr<thread_buffer>> buffers;
+        uint32_t next_thread_id = 0;
+
+        int64_t frame_start = 0;
+        int64_t last_frame_ns = 0;
+        vector<zone_summary> last_frame;
+    };
+
+    inline state& get_state() {
+        static state s;
+        return s;
+    }
+
+    inline thread_buffer& this_thread_buffer() {
+        //the calling threads buffer, registered the first time a thread records a zone
+        //buffers are shared so records outlive the thread and still show up in exports
+        thread_local std::shared_ptr<thread_buffer> buffer;
+        if (!buffer) {
+            buffer = std::make_shared<thread_buffer>();
+            state& s = get_state();
+            std::lock_guard<std::mutex> lock(s.registry_mutex);
+            buffer->thread_id = s.next_thread_id++;
+            s.buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    inline void set_enabled(bool b) {
+        get_state().enabled.store(b, std::memory_order_relaxed);
+    }
+
+    inline bool is_enabled() {
+        return get_state().enabled.load(std::memory_order_relaxed);
+    }
+
+    /*
+    times the scope it lives in, name must outlive the profiler (use a string literal)
+    zones that start while the profiler is disabled are not recorded even if it is enabled before they end
+    */
+    class zone {
+        private:
+        const char* name;
+        int64_t start = 0;
+        thread_buffer* buffer = nullptr;
+
+        public:
+        explicit zone(const char* n) : name(n) {
+            if (!is_enabled()) return;
+            buffer = &this_thread_buffer();
+            buffer->depth++;
+            start = now_ns();
+        }
+
+        ~zone() {
+            if (buffer == nullptr) return;
+            int64_t end = now_ns();
+            buffer->depth--;
+            buffer->push({name, start, end, buffer->depth});
+        }
+
+        zone(const zone&) = delete;
+        zone& operator=(const zone&) = delete;
+    };
+
+    inline void begin_frame() {
+        //marks the start of a frame, zones that end after this count towards it
+        get_state().frame_start = now_ns();
+    }
+
+    inline void end_frame() {
+        /*
+        ends the frame and sums up every zone that finished since profiler::begin_frame, by name, on every thread
+        call it from one thread only, the results are in profiler::get_last_frame
+        */
+        state& s = get_state();
+        int64_t frame_end = now_ns();
+        s.last_frame_ns = frame_end - s.frame_start;
+        s.last_frame.clear();
+
+        std::lock_guard<std::mutex> lock(s.registry_mutex);
+        for (std::shared_ptr<thread_buffer>& b : s.buffers) {
+            b->summary_cursor = b->read(b->summary_cursor, [&](const zone_record& z) {
+                if (z.end < s.frame_start || z.end > frame_end) return;
+                //names are usually literals so matching the pointer is enough, compare the text in case the same name was typed twice
+                for (zone_summary& sum : s.last_frame) {
+                    if (sum.name == z.name || strcmp(sum.name, z.name) == 0) {
+                        int64_t ns = z.end - z.start;
+                        sum.total_ns += ns;
+                        sum.max_ns = std::max(sum.max_ns, ns);
+                        sum.calls++;
+                        sum.depth = std::min(sum.depth, z.depth);
+                        return;
+                    }
+                }
+                s.last_frame.push_back({z.name, z.end - z.start, z.end - z.start, 1, z.depth});
+            });
+        }
+
+        std::sort(s.last_frame.begin(), s.last_frame.end(), [](const zone_summary& a, const zone_summary& b) {
+            return a.total_ns > b.total_ns;
+        });
+    }
+
+    inline const vector<zone_summary>& get_last_frame() {
+        //every zone from the last frame, the most expensive first
+        return get_state().last_frame;
+    }
+
+    inline seconds_t get_last_frame_time() {
+        //the time between the last profiler::begin_frame and profiler::end_frame
+        return get_state().last_frame_ns / 1000000000.0L;
+    }
+
+    inline void clear() {
+        //forgets every record made so far on every thread, so the next export only has what comes after
+        //buffers of threads that have exited are freed here too
+        state& s = get_state();
+        std::lock_guard<std::mutex> lock(s.registry_mutex);
+        s.buffers.erase(std::remove_if(s.buffers.begin(), s.buffers.end(), [](const std::shared_ptr<thread_buffer>& b) {
+            return b.use_count() == 1;
+        }), s.buffers.end());
+        for (std::shared_ptr<thread_buffer>& b : s.buffers) {
+            b->cleared = b->written.load(std::memory_order_acquire);
+            b->summary_cursor = b->cleared;
+        }
+        s.last_frame.clear();
+    }
+
+    inline void write_json_string(std::ostream& os, const char* str) {
+        os << '"';
+        for (const char* c = str; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') os << '\\' << *c;
+            else if (static_cast<unsigned char>(*c) < 0x20) os << ' ';
+            else os << *c;
+        }
+        os << '"';
+    }
+
+    inline void write_chrome_trace(std::ostream& os) {
+        //writes every record still in the rings as chrome trace event json (complete events, times in microseconds)
+        state& s = get_state();
+        std::lock_guard<std::mutex> lock(s.registry_mutex);
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        char buf[64];
+        for (std::shared_ptr<thread_buffer>& b : s.buffers) {
+            b->read(0, [&](const zone_record& z) {
+                if (!first) os << ",";
+                first = false;
+                os << "\n{\"name\":";
+                write_json_string(os, z.name);
+                snprintf(buf, sizeof(buf), "%.3f", z.start / 1000.0);
+                os << ",\"cat\":\"celerit\",\"ph\":\"X\",\"ts\":" << buf;
+                snprintf(buf, sizeof(buf), "%.3f", (z.end - z.start) / 1000.0);
+                os << ",\"dur\":" << buf << ",\"pid\":1,\"tid\":" << b->thread_id << "}";
+            });
+        }
+        os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    inline void write_chrome_trace(const string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: could not open profiler trace " << path << "\n";
+            exit(-1);
+        }
+        write_chrome_trace(out);
+    }
+}
+
+#define CELERIT_PROFILE_CONCAT_INNER(a, b) a##b
+#define CELERIT_PROFILE_CONCAT(a, b) CELERIT_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef CELERIT_NO_PROFILER
+#define CELERIT_PROFILE_ZONE(name)
+#else
+//times the rest of the enclosing scope as a zone called <name>
+#define CELERIT_PROFILE_ZONE(name) profiler::zone CELERIT_PROFILE_CONCAT(celerit_profile_zone_, __LINE__)(name)
+#endif
+
+
+#endif
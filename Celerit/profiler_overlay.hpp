@@ -0,0 +1,52 @@
+#ifndef PROFILER_OVERLAY
+#define PROFILER_OVERLAY
+
+#include "profiler.hpp"
+#include "text_stream.hpp"
+
+
+/*
+Draws the last frame the profiler summed up (see profiler::end_frame) as text, one line per zone,
+the most expensive zones first and nested zones indented under the zones they ran in
+the text goes through a text_stream so lines that didnt change since the last frame arent laid out again
+*/
+class profiler_overlay {
+    private:
+    text_stream stream;
+    int max_rows;
+
+    public:
+
+    profiler_overlay(renderer& r, font& f, dvec2 pos = {10, 10}, color c = {255, 255, 255, 255}, int rows = 12) : stream(r, pos, f, c) {
+        //creates an overlay at pos that shows at most <rows> zones
+        max_rows = rows;
+    }
+
+    void set_max_rows(int rows) {
+        max_rows = rows;
+    }
+
+    void change_color(color c) {
+        stream.change_color(c);
+    }
+
+    void draw() {
+        //draws the summary from the last profiler::end_frame
+        const vector<profiler::zone_summary>& zones = profiler::get_last_frame();
+
+        stream << tstream::TRUNCATE(2) << "frame " << static_cast<double>(profiler::get_last_frame_time() * 1000.0L) << " ms";
+        if (!profiler::is_enabled()) stream << " (profiler disabled)";
+
+        int rows = std::min(max_rows, static_cast<int>(zones.size()));
+        for (int i = 0; i < rows; i++) {
+            const profiler::zone_summary& z = zones[i];
+            string line = "\n" + string(z.depth * 2, ' ') + z.name + "  ";
+            stream << tstream::TRUNCATE(2) << line << z.total_ns / 1000000.0 << " ms  x" << z.calls
+                   << "  max " << z.max_ns / 1000000.0 << " ms";
+        }
+        stream.flush();
+    }
+};
+
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef RENDER_SNAPSHOT
+#define RENDER_SNAPSHOT
+
+#include "renderer.hpp"
+
+
+/*
+everything one frame draws, copied out of the game objects as a list of quads
+filling one in only reads the objects, and drawing one only reads the snapshot, so the simulation can fill in the next
+frame while the last one is being drawn (see frame_pipeline)
+
+sprites, particle emitters and UI elements fill snapshots in with their capture functions
+*/
+struct render_snapshot {
+    //one textured or plain quad, already in screen space
+    struct quad {
+        //copied by value, so the quad doesnt point into an object that might have changed since
+        texture tex;
+        bool has_texture;
+        rect source;
+        rect dest;
+        double angle;
+        dvec2 center;
+        color tint;
+        SDL_RendererFlip flip;
+    };
+
+    std::vector<quad> quads;
+    //which simulation step the snapshot was taken after, set by whoever fills it in
+    unsigned long long frame = 0;
+
+    void clear() {
+        //empties the snapshot, keeping its memory for the next frame
+        quads.clear();
+    }
+
+    void add(texture& t, rect source, rect dest, double angle = 0.0, dvec2 center = {0, 0}, color tint = WHITE, SDL_RendererFlip flip = SDL_FLIP_NONE) {
+        quads.push_back({t, true, source, dest, angle, center, tint, flip});
+    }
+
+    void add_rect(rect dest, color c) {
+        quads.push_back({texture(), false, {0, 0, 0, 0}, dest, 0.0, {0, 0}, c, SDL_FLIP_NONE});
+    }
+
+    size_t size() const {
+        return quads.size();
+    }
+
+    void draw(renderer& r) {
+        //draws every quad in the order they were added, as one batch
+        for (quad& q: quads) {
+            if (q.has_texture) {
+                r.queue_texture(q.tex, q.source, q.dest, q.angle, q.center, q.flip, q.tint);
+            } else {
+                r.queue_rect(q.dest, q.tint);
+            }
+        }
+        if (!r.get_batching()) r.flush_batch();
+    }
+};
+
+
+#endif
@@ -4,6 +4,8 @@
 #include "screen.hpp"
 #include "util.hpp"
 #include "font.hpp"
+#include "profiler.hpp"
+#include <memory>
 
 
 
@@ -14,7 +16,32 @@ class renderer {
     //the internal SDL_Renderer and the screen rectangle
     SDL_Renderer* rend;
     rect screen_rect;
+    //what drawing is culled against, the screen normally or the texture while a render target is set
+    rect cull_rect;
+    //the size of whatever is being drawn to, cull_rect is this cut down to the clip rect while one is set
+    rect target_rect;
+
+    //a run of consecutive batched quads that all share the same texture, each run is one SDL_RenderGeometry call
+    //runs are kept in submission order so that layering stays the same as with immediate drawing
+    struct batch_run {
+        SDL_Texture* tex;
+        int first_vertex;
+        int first_index;
+        int quad_count;
+    };
+
+    //the batched sprite queue, only filled when batching is enabled (or through renderer::queue_texture)
+    bool batching = false;
+    std::vector<SDL_Vertex> batch_vertices;
+    std::vector<int> batch_indices;
+    std::vector<batch_run> batch_runs;
+
+    //the number of draw calls handed to SDL during the current frame, and during the last presented frame
+    int frame_draw_calls = 0;
+    int last_frame_draw_calls = 0;
 
+    //reused by render_text and render_aatext so laying out a string doesnt allocate every call
+    text_layout text_scratch;
 
     
     
@@ -31,9 +58,11 @@ class renderer {
     class texture {
         private:
         //stores the textures rect and the actual texture itself
-        SDL_Texture* text;
+        SDL_Texture* text = nullptr;
         rect texture_rect = {0, 0, 0, 0};
         //storing the rect itself is easier and much faster than manually querying the texture every single time we need it
+        //the real size of the texture in pixels, texture_rect can be scaled so it cant be used for texture coordinates
+        ivec2 pixel_size = {0, 0};
 
         public:
 
@@ -44,17 +73,20 @@ class renderer {
             //loads a texture from an image file
             text = IMG_LoadTexture((&r)->get_sdl_renderer(), file.c_str());
             SDL_QueryTexture(text, NULL, NULL, &texture_rect.w, &texture_rect.h);
+            pixel_size = {texture_rect.w, texture_rect.h};
         }
 
         texture(SDL_Texture* t) {
             //converts an SDL_Texture to a texture
             text = t;
             SDL_QueryTexture(text, NULL, NULL, &texture_rect.w, &texture_rect.h);
+            pixel_size = {texture_rect.w, texture_rect.h};
         }
 
         texture(renderer& r, int w, int h) {
             texture_rect.w = w;
             texture_rect.h = h;
+            pixel_size = {w, h};
             text = SDL_CreateTexture(r.get_sdl_renderer(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
             SDL_SetTextureBlendMode(text, SDL_BLENDMODE_BLEND);
         }
@@ -84,6 +116,11 @@ class renderer {
             return texture_rect;
         }
 
+        ivec2 get_pixel_size() const {
+            //returns the actual size of the texture in pixels, unaffected by texture::scale
+            return pixel_size;
+        }
+
         void scale(int scalar) {
             //scales the texture by an integer scaling
             if (text == nullptr) {
@@ -113,24 +150,193 @@ class renderer {
             SDL_DestroyTexture(text);
             text = nullptr;//no use after frees here
             texture_rect = {0, 0, 0, 0};
+            pixel_size = {0, 0};
+        }
+    };
+
+
+    //hit and miss counts and memory use of the texture cache, see renderer::load_texture
+    struct texture_cache_stats {
+        int hits = 0;
+        int misses = 0;
+        int resident_textures = 0;
+        //estimated from the texture sizes, every texture is counted as 4 bytes per pixel
+        size_t resident_bytes = 0;
+    };
+
+    protected:
+
+    struct cached_texture;
+
+    //shared between the renderer and every cached texture, so a handle that outlives the renderer doesnt touch freed memory
+    struct texture_cache_state {
+        bool renderer_alive = true;
+        //only used while renderer_alive is set
+        renderer* owner = nullptr;
+        texture_cache_stats stats;
+        std::unordered_map<string, std::weak_ptr<cached_texture>> entries;
+    };
+
+    //a texture owned by the cache, alive for as long as there is a texture_handle to it
+    struct cached_texture {
+        texture tex;
+        SDL_Texture* owned;
+        string path;
+        size_t bytes;
+        std::shared_ptr<texture_cache_state> cache;
+
+        ~cached_texture() {
+            //the last handle is gone, so give the memory back
+            cache->entries.erase(path);
+            cache->stats.resident_textures--;
+            cache->stats.resident_bytes -= bytes;
+            //destroying the renderer already destroyed all of its textures
+            if (cache->renderer_alive) {
+                cache->owner->flush_if_queued(owned);
+                SDL_DestroyTexture(owned);
+            }
         }
     };
 
+    std::shared_ptr<texture_cache_state> texture_cache = std::make_shared<texture_cache_state>();
 
+    //handed to every font queue_text draws from, see font::set_atlas_batch
+    std::shared_ptr<std::function<void()>> font_batch_flush = std::make_shared<std::function<void()>>([this] { flush_batch(); });
+
+    void flush_if_queued(SDL_Texture* t) {
+        //flushes the batch if any quad waiting in it draws <t>, has to be called before <t> is destroyed
+        for (batch_run& run: batch_runs) {
+            if (run.tex == t) {
+                flush_batch();
+                return;
+            }
+        }
+    }
+
+    public:
+
+    //a refrence counted handle to a texture loaded with renderer::load_texture, copying one is cheap
+    //the texture is destroyed when the last handle to it is gone, so never call texture::destroy_texture on it
+    class texture_handle {
+        friend class renderer;
+        private:
+        std::shared_ptr<cached_texture> entry;
+
+        texture_handle(std::shared_ptr<cached_texture> e) : entry(std::move(e)) {}
+
+        public:
+        texture_handle() {}//creates a null handle
+
+        texture& get() const {
+            //returns the shared texture, scaling it scales it for every handle so copy it first if you need to
+            if (entry == nullptr) {
+                cerr << "Error: texture_handle<" << this << ">" << "does not refrence a texture\n";
+                exit(-1);
+            }
+            return entry->tex;
+        }
+
+        operator texture&() const {
+            return get();
+        }
 
-    renderer(screen s) {
-        //creates a hardware renderer with alpha blending
-        rend = SDL_CreateRenderer(s.get_sdl_window(), -1, SDL_RENDERER_ACCELERATED);
+        bool is_null() const {
+            return entry == nullptr;
+        }
+
+        long use_count() const {
+            //the number of handles to this texture, including this one
+            return entry.use_count();
+        }
+    };
+
+
+
+    renderer(screen& s) {
+        //creates a hardware renderer with alpha blending, or a software renderer drawing into the surface of a headless screen
+        if (s.is_headless()) {
+            rend = SDL_CreateSoftwareRenderer(s.get_sdl_surface());
+        } else {
+            rend = SDL_CreateRenderer(s.get_sdl_window(), -1, SDL_RENDERER_ACCELERATED);
+        }
+        if (rend == nullptr) {
+            cerr << "Error: could not create a renderer: " << SDL_GetError() << "\n";
+            exit(-1);
+        }
         SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_BLEND);
+        texture_cache->owner = this;
         screen_rect = s.get_screen_rect();
+        target_rect = screen_rect;
+        cull_rect = screen_rect;
     }
 
     void set_render_target(texture& t) {
+        //anything queued was meant for the old target, changing the target also removes the clip rect
+        flush_batch();
         SDL_SetRenderTarget(rend, t.get_sdl_texture());
+        SDL_RenderSetClipRect(rend, nullptr);
+        target_rect = {0, 0, t.get_pixel_size().x, t.get_pixel_size().y};
+        cull_rect = target_rect;
     }
 
     void reset_target() {
+        flush_batch();
         SDL_SetRenderTarget(rend, nullptr);
+        SDL_RenderSetClipRect(rend, nullptr);
+        target_rect = screen_rect;
+        cull_rect = screen_rect;
+    }
+
+    //what drawing into another target changes, see renderer::save_target
+    struct target_state {
+        SDL_Texture* target;
+        rect target_rect;
+        rect cull_rect;
+        bool clipped;
+        rect clip;
+    };
+
+    target_state save_target() {
+        //the current target and clip rect, for drawing into a texture and then going back to whatever was being drawn to
+        target_state s;
+        s.target = SDL_GetRenderTarget(rend);
+        s.target_rect = target_rect;
+        s.cull_rect = cull_rect;
+        s.clipped = SDL_RenderIsClipEnabled(rend) == SDL_TRUE;
+        SDL_RenderGetClipRect(rend, &s.clip);
+        return s;
+    }
+
+    void restore_target(const target_state& s) {
+        //puts back a target saved with renderer::save_target
+        flush_batch();
+        SDL_SetRenderTarget(rend, s.target);
+        SDL_RenderSetClipRect(rend, s.clipped ? &s.clip : nullptr);
+        target_rect = s.target_rect;
+        cull_rect = s.cull_rect;
+    }
+
+    void set_clip_rect(rect r) {
+        //only lets drawing touch the pixels inside r, anything entirely outside of it is skipped before it reaches SDL
+        flush_batch();
+        SDL_RenderSetClipRect(rend, &r);
+        cull_rect = intersect_rect(target_rect, r);
+    }
+
+    void reset_clip_rect() {
+        flush_batch();
+        SDL_RenderSetClipRect(rend, nullptr);
+        cull_rect = target_rect;
+    }
+
+    void clear_rect(rect r, color c) {
+        //replaces the pixels in r with c, unlike draw_rect the color isnt blended with whats already there
+        flush_batch();
+        SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_NONE);
+        SetColor(rend, c);
+        SDL_RenderFillRect(rend, &r);
+        SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_BLEND);
+        frame_draw_calls++;
     }
 
     SDL_Renderer* get_sdl_renderer() {
@@ -143,48 +349,220 @@ class renderer {
         return screen_rect;
     }
 
+    bool read_pixels(rect area, void* pixels, int pitch) {
+        /*
+        copies the pixels in area of the current target into pixels as ARGB8888, pitch is the length of one row in bytes
+        anything still queued is drawn first, returns false if SDL couldnt read the target back
+        this stalls until the GPU catches up, so it is meant for tests and screenshots rather than every frame
+        */
+        flush_batch();
+        return SDL_RenderReadPixels(rend, &area, SDL_PIXELFORMAT_ARGB8888, pixels, pitch) == 0;
+    }
+
+    bool read_pixels(std::vector<uint32_t>& out) {
+        //copies the whole current target into out as ARGB8888, one uint32_t per pixel row by row
+        out.resize(static_cast<size_t>(target_rect.w) * target_rect.h);
+        return read_pixels(target_rect, out.data(), target_rect.w * static_cast<int>(sizeof(uint32_t)));
+    }
+
+    bool save_png(const string& file) {
+        //saves the current target to a png file, returns false if it couldnt be read back or written
+        SDL_Surface* shot = SDL_CreateRGBSurfaceWithFormat(0, target_rect.w, target_rect.h, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (shot == nullptr) return false;
+        bool ok = read_pixels(target_rect, shot->pixels, shot->pitch) && IMG_SavePNG(shot, file.c_str()) == 0;
+        if (!ok) cerr << "Error: could not save " << file << ": " << SDL_GetError() << "\n";
+        SDL_FreeSurface(shot);
+        return ok;
+    }
+
     texture create_texture(string file) {
         //creates a texture
         return texture(*this, file);
     }
 
+    texture_handle load_texture(const string& file) {
+        //loads a texture through the texture cache, a file that is already loaded is shared instead of decoded again
+        texture_handle found = find_texture(file);
+        if (!found.is_null()) return found;
+
+        SDL_Texture* loaded = IMG_LoadTexture(rend, file.c_str());
+        if (loaded == nullptr) {
+            cerr << "Error: could not load texture " << file << ": " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+        return adopt_texture(file, loaded);
+    }
+
+    texture_handle find_texture(const string& file) {
+        //returns the cached texture for a file, or a null handle if it isnt loaded
+        auto found = texture_cache->entries.find(file);
+        if (found != texture_cache->entries.end()) {
+            if (std::shared_ptr<cached_texture> entry = found->second.lock()) {
+                texture_cache->stats.hits++;
+                return texture_handle(entry);
+            }
+        }
+        return texture_handle();
+    }
+
+    texture_handle adopt_texture(const string& file, SDL_Texture* t) {
+        /*
+        hands a texture that was loaded some other way (see asset_loader) over to the cache under the name <file>
+        the cache owns it from then on, if the file got loaded in the meantime <t> is destroyed and the cached one is returned
+        */
+        texture_handle found = find_texture(file);
+        if (!found.is_null()) {
+            SDL_DestroyTexture(t);
+            return found;
+        }
+        texture_cache->stats.misses++;
+
+        std::shared_ptr<cached_texture> entry = std::make_shared<cached_texture>();
+        entry->tex = texture(t);
+        entry->owned = t;
+        entry->path = file;
+        entry->bytes = (size_t)entry->tex.get_pixel_size().x * entry->tex.get_pixel_size().y * 4;
+        entry->cache = texture_cache;
+
+        texture_cache->entries[file] = entry;
+        texture_cache->stats.resident_textures++;
+        texture_cache->stats.resident_bytes += entry->bytes;
+        return texture_handle(entry);
+    }
+
+    texture_cache_stats get_texture_cache_stats() const {
+        return texture_cache->stats;
+    }
+
     void update() {
         //presents the render
+        CELERIT_PROFILE_ZONE("renderer::update");
+        flush_batch();
         SDL_RenderPresent(rend);
+
+        last_frame_draw_calls = frame_draw_calls;
+        frame_draw_calls = 0;
+    }
+
+    void set_batching(bool b) {
+        /*
+        turns the batched sprite queue on or off
+        while batching is on every blit_texture call is queued instead of drawn, and the queue is flushed
+        with one SDL_RenderGeometry call per run of quads sharing a texture
+        the queue is flushed automatically before anything is drawn immediately, on target changes and on renderer::update
+        so queued quads (including queue_texture and queue_rect with batching off) always end up under what is drawn after them
+        queued quads only point at their textures, so a texture that might still be queued has to be destroyed with
+        renderer::destroy_texture (or after a flush) rather than texture::destroy_texture
+        the engines own textures (cached textures, font atlases, tilemap chunks and so on) already do this
+        */
+        if (!b) flush_batch();
+        batching = b;
+    }
+
+    bool get_batching() {
+        //returns whether blit_texture calls are being batched
+        return batching;
+    }
+
+    int get_draw_calls() {
+        //returns how many draw calls were actually issued to SDL during the last presented frame
+        return last_frame_draw_calls;
+    }
+
+    int get_batched_quads() {
+        //returns how many quads are currently waiting in the batch queue
+        return static_cast<int>(batch_indices.size() / 6);
+    }
+
+    void queue_texture(texture& t, rect source, rect dest, double angle = 0.0, dvec2 center = {0, 0}, SDL_RendererFlip flip = SDL_FLIP_NONE, color tint = WHITE) {
+        //queues a texture into the batch regardless of whether batching is on, and with a color tint
+        SDL_Point p = center;
+        if (collide_rect(dest, cull_rect)) push_quad(t.get_sdl_texture(), t.get_pixel_size(), source, dest, angle, p, flip, tint);
+    }
+
+    void queue_rect(rect dest, color c) {
+        //queues a filled rect into the batch, it is drawn without a texture so queued rects share runs with eachother
+        SDL_Point no_center = {0, 0};
+        if (collide_rect(dest, cull_rect)) push_quad(nullptr, {1, 1}, {0, 0, 1, 1}, dest, 0.0, no_center, SDL_FLIP_NONE, c);
+    }
+
+    void queue_text(font& fnt, const text_layout& layout, ivec2 pos, color fg) {
+        //queues an already laid out line of text at pos, the layout must come from fnt and still be current (see font::get_atlas_generation)
+        SDL_Point no_center = {0, 0};
+        fnt.set_atlas_batch(font_batch_flush);
+        for (const placed_glyph& g: layout.glyphs) {
+            rect src = {g.src.x, g.src.y, g.src.w, g.src.h};
+            rect dest = {pos.x + g.x, pos.y, g.src.w, g.src.h};
+            if (collide_rect(dest, cull_rect)) {
+                push_quad(fnt.get_atlas_page(g.page), fnt.get_atlas_page_size(g.page), src, dest, 0.0, no_center, SDL_FLIP_NONE, fg);
+            }
+        }
+    }
+
+    void destroy_texture(texture& t) {
+        //destroys a texture, flushing the batch first if any quad waiting in it still draws the texture
+        flush_if_queued(t.get_sdl_texture());
+        t.destroy_texture();
+    }
+
+    void flush_batch() {
+        //draws everything in the batch queue, one draw call per texture run
+        if (batch_runs.empty()) return;
+        CELERIT_PROFILE_ZONE("renderer::flush_batch");
+        for (batch_run& run: batch_runs) {
+            SDL_RenderGeometry(rend, run.tex, batch_vertices.data() + run.first_vertex, run.quad_count*4,
+                                batch_indices.data() + run.first_index, run.quad_count*6);
+            frame_draw_calls++;
+        }
+
+        batch_runs.clear();
+        batch_vertices.clear();
+        batch_indices.clear();
     }
 
     void fill(color c) {
         //fills the screen with the color
+        //anything queued was drawn before the fill, so it is flushed first just like every other immediate draw
+        flush_batch();
+
         SetColor(rend, c);
         SDL_RenderClear(rend);
+        frame_draw_calls++;
     }
 
     void draw_point(color c, int x, int y) {
+        flush_batch();
         SetColor(rend, c);
         SDL_RenderDrawPoint(rend, x, y);
+        frame_draw_calls++;
     }
 
     void draw_point(color c, ivec2 pos) {
+        flush_batch();
         SetColor(rend, c);
         SDL_RenderDrawPoint(rend, pos.x, pos.y);
+        frame_draw_calls++;
     }
 
     void draw_line(int x1, int y1, int x2, int y2, color c, int width = 1, bool aaliasing = false) {
         //draws a line from a to b with a specified width and very basic anti-aliasing if you enable it
         rect r = {x1, y1, x2-x1, y2-y1};
-        if (collide_rect(r, screen_rect)) {
+        if (collide_rect(r, cull_rect)) {
+            flush_batch();
             SetColor(rend, c);
             int offset = 0;
             
             for (; offset < width - (width != 1 && aaliasing); offset++) {
                 SDL_RenderDrawLine(rend, x1+offset, y1, x2+offset, y2);
                 SDL_RenderDrawLine(rend, x1-offset, y1, x2-offset, y2);
+                frame_draw_calls += 2;
             }
             if (aaliasing) {
                 c = {c.r, c.g, c.b, static_cast<uint8_t>(c.a/4)};
                 SetColor(rend, c);
                 SDL_RenderDrawLine(rend, x1+offset, y1, x2+offset, y2);
                 SDL_RenderDrawLine(rend, x1-offset, y1, x2-offset, y2);
+                frame_draw_calls += 2;
             }
             
         }
@@ -198,19 +576,22 @@ class renderer {
         int y1 = static_cast<int>(p1.y);
         int y2 = static_cast<int>(p2.y);
         rect r = {x1, y1, x2-x1, y2-y1};
-        if (collide_rect(r, screen_rect)) {
+        if (collide_rect(r, cull_rect)) {
+            flush_batch();
             SetColor(rend, c);
             int offset = 0;
             
             for (; offset < width - (width != 1 && aaliasing); offset++) {
                 SDL_RenderDrawLine(rend, x1+offset, y1, x2+offset, y2);
                 SDL_RenderDrawLine(rend, x1-offset, y1, x2-offset, y2);
+                frame_draw_calls += 2;
             }
             if (aaliasing) {
                 c = {c.r, c.g, c.b, static_cast<uint8_t>(c.a/4)};
                 SetColor(rend, c);
                 SDL_RenderDrawLine(rend, x1+offset, y1, x2+offset, y2);
                 SDL_RenderDrawLine(rend, x1-offset, y1, x2-offset, y2);
+                frame_draw_calls += 2;
             }
             
         }
@@ -225,19 +606,22 @@ class renderer {
         int y1 = static_cast<int>(ln.p1.y);
         int y2 = static_cast<int>(ln.p2.y);
         rect r = {x1, y1, x2-x1, y2-y1};
-        if (collide_rect(r, screen_rect)) {
+        if (collide_rect(r, cull_rect)) {
+            flush_batch();
             SetColor(rend, c);
             int offset = 0;
             
             for (; offset < width - (width != 1 && aaliasing); offset++) {
                 SDL_RenderDrawLine(rend, x1+offset, y1, x2+offset, y2);
                 SDL_RenderDrawLine(rend, x1-offset, y1, x2-offset, y2);
+                frame_draw_calls += 2;
             }
             if (aaliasing) {
                 c = {c.r, c.g, c.b, static_cast<uint8_t>(c.a/4)};
                 SetColor(rend, c);
                 SDL_RenderDrawLine(rend, x1+offset, y1, x2+offset, y2);
                 SDL_RenderDrawLine(rend, x1-offset, y1, x2-offset, y2);
+                frame_draw_calls += 2;
             }
             
         }
@@ -255,15 +639,18 @@ class renderer {
             x1 = x1+h;
             w = -w;
         }
-        if (collide_rect(r, screen_rect)) {
+        if (collide_rect(r, cull_rect)) {
+            flush_batch();
             SetColor(rend, c);
             
             
             if (width <= 0) {
                 SDL_RenderFillRect(rend, &r);
+                frame_draw_calls++;
             } else {
                 for (int _ = 0; _ < width; _++) {
                     SDL_RenderDrawRect(rend, &r);
+                    frame_draw_calls++;
                     r.x += 1;
                     r.y += 1;
                     r.w -= 2;
@@ -276,15 +663,18 @@ class renderer {
 
     void draw_rect(rect r, color c, int width = 0) {
         //draws a rect on screen with a specified width
-        if (collide_rect(r, screen_rect)) {
+        if (collide_rect(r, cull_rect)) {
+            flush_batch();
             SetColor(rend, c);
             
             
             if (width <= 0) {
                 SDL_RenderFillRect(rend, &r);
+                frame_draw_calls++;
             } else {
                 for (int _ = 0; _ < width; _++) {
                     SDL_RenderDrawRect(rend, &r);
+                    frame_draw_calls++;
                     r.x += 1;
                     r.y += 1;
                     r.w -= 2;
@@ -306,15 +696,15 @@ class renderer {
     void blit_texture(texture& t,  rect source, rect dest, double angle = 0.0, dvec2 center = {0, 0}, SDL_RendererFlip flip = SDL_FLIP_NONE) {
         //draws a texture with a source rect (where from the texture) and a destination rect (where to render) and with rotation and flip around a relative center
         SDL_Point p = center;
-        if (collide_rect(dest, screen_rect)) SDL_RenderCopyEx(rend, t.get_sdl_texture(), &source, &dest, angle, &p, flip);
+        if (collide_rect(dest, cull_rect)) copy_texture(t, source, dest, angle, p, flip);
     }
 
     void blit_texture(texture& t, rect dest, double angle = 0.0, dvec2 center = {0, 0}, SDL_RendererFlip flip = SDL_FLIP_NONE) {
         //blits a texture with a destination rect (where to render) and with rotation and flip around a relative center
         SDL_Point p = center;
-        if (collide_rect(dest, screen_rect)) {
+        if (collide_rect(dest, cull_rect)) {
             rect r = t.get_rect();
-            SDL_RenderCopyEx(rend, t.get_sdl_texture(), &r, &dest, angle, &p, flip);
+            copy_texture(t, r, dest, angle, p, flip);
         }
     }
 
@@ -324,7 +714,7 @@ class renderer {
         SDL_Point p = center;
         rect src = t.get_rect();
         rect r = {static_cast<int>(round(vec.x)), static_cast<int>(round(vec.y)), src.w, src.h};
-        if (collide_rect(r, screen_rect)) SDL_RenderCopyEx(rend, t.get_sdl_texture(), &src, &r, angle, &p, flip);
+        if (collide_rect(r, cull_rect)) copy_texture(t, src, r, angle, p, flip);
     }
 
     void blit_texture(texture& t, int x, int y, double angle = 0.0, dvec2 center = {0, 0}, SDL_RendererFlip flip = SDL_FLIP_NONE) {
@@ -332,7 +722,7 @@ class renderer {
         SDL_Point p = center;
         rect src = t.get_rect();
         rect r = {x, y, src.w, src.h};
-        if (collide_rect(r, screen_rect)) SDL_RenderCopyEx(rend, t.get_sdl_texture(), &src, &r, angle, &p, flip);
+        if (collide_rect(r, cull_rect)) copy_texture(t, src, r, angle, p, flip);
     }
 
     template<typename T = int, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
@@ -341,30 +731,19 @@ class renderer {
         draws text onto the screen using the specified font and fg and background colors
         returns the width and height of the text
         */
-
-        SDL_Surface* rendered_text;
-
-        if (bg.a > 0) {
-            rendered_text = TTF_RenderText(fnt.get_sdl_font(), text.c_str(), fg, bg);
-        } else {
-            rendered_text = TTF_RenderText_Solid(fnt.get_sdl_font(), text.c_str(), fg);
+        //a background gets anti-aliased glyphs on top of it, just like TTF_RenderText_Shaded
+        fnt.layout_text(rend, text, bg.a > 0, text_scratch);
+        rect dest = {static_cast<int>(pos.x), static_cast<int>(pos.y), text_scratch.size.x, text_scratch.size.y};
+
+        if (text_scratch.size.x > 0 && collide_rect(dest, cull_rect)) {
+            if (bg.a > 0) draw_rect(dest, bg);
+            queue_text(fnt, text_scratch, {dest.x, dest.y}, fg);
+            if (!batching) flush_batch();
         }
-        SDL_Texture* t = SDL_CreateTextureFromSurface(rend, rendered_text);
-
 
-        rect text_rect = {0, 0, 0, 0};
-        SDL_QueryTexture(t, nullptr, nullptr, &text_rect.w, &text_rect.h);
-        rect dest = text_rect;
-        dest.x = pos.x;
-        dest.y = pos.y;
-        if (collide_rect(dest, screen_rect)) SDL_RenderCopy(rend, t, &text_rect, &dest);
-        SDL_DestroyTexture(t);
-        SDL_FreeSurface(rendered_text);
-
-        return {text_rect.w, text_rect.h};
+        return text_scratch.size;
     }
 
-
     void draw_circle(int centerX, int centerY, int radius, color c, bool filled = false) {
         //draws a circle centered at X, Y with a radius and can be filled or not filled
 
@@ -372,10 +751,11 @@ class renderer {
         // Check if the circle is within the screen rectangle
         
         rect boundingBox = { centerX - radius, centerY - radius, 2 * radius, 2 * radius };
-        if (!collide_rect(boundingBox, screen_rect)) {
+        if (!collide_rect(boundingBox, cull_rect)) {
             return; // Circle is out of bounds
         }
 
+        flush_batch();
         SetColor(rend, c); // Set the drawing color
         
 
@@ -385,6 +765,7 @@ class renderer {
                 int xLimit = static_cast<int>(sqrt(radius * radius - y * y)); // Calculate the x limit
                 SDL_RenderDrawLine(rend, centerX - xLimit, centerY + y, centerX + xLimit, centerY + y); // Draw horizontal line
             }
+            frame_draw_calls += 2*radius + 1;
         } else {
             // Draw an outline circle using Midpoint Circle Algorithm
         
@@ -402,6 +783,7 @@ class renderer {
                 SDL_RenderDrawPoint(rend, centerX + y, centerY - x);
                 SDL_RenderDrawPoint(rend, centerX - x, centerY - y);
                 SDL_RenderDrawPoint(rend, centerX - y, centerY - x);
+                frame_draw_calls += 8;
 
                 y++;
 
@@ -423,29 +805,84 @@ class renderer {
         draws text with anti aliasing
         returns the width and height of the text
         */
+        fnt.layout_text(rend, text, true, text_scratch);
+        rect dest = {static_cast<int>(pos.x), static_cast<int>(pos.y), text_scratch.size.x, text_scratch.size.y};
 
-        SDL_Surface* rendered_text;
+        if (text_scratch.size.x > 0 && collide_rect(dest, cull_rect)) {
+            queue_text(fnt, text_scratch, {dest.x, dest.y}, fg);
+            if (!batching) flush_batch();
+        }
 
-        
-        rendered_text = TTF_RenderText_Blended(fnt.get_sdl_font(), text.c_str(), fg);
-        
-        SDL_Texture* t = SDL_CreateTextureFromSurface(rend, rendered_text);
+        return text_scratch.size;
+    }
 
+    ~renderer() {
+        texture_cache->renderer_alive = false;
+        SDL_DestroyRenderer(rend);
+    }
 
-        rect text_rect = {0, 0, 0, 0};
-        SDL_QueryTexture(t, nullptr, nullptr, &text_rect.w, &text_rect.h);
-        rect dest = text_rect;
-        dest.x = pos.x;
-        dest.y = pos.y;
-        if (collide_rect(dest, screen_rect)) SDL_RenderCopy(rend, t, &text_rect, &dest);
-        SDL_DestroyTexture(t);
-        SDL_FreeSurface(rendered_text);
+    protected:
 
-        return {text_rect.w, text_rect.h};
+    void copy_texture(texture& t, rect& source, rect& dest, double angle, SDL_Point center, SDL_RendererFlip flip) {
+        //the common end of every blit_texture overload, either queues the quad or draws it right away
+        if (batching) {
+            push_quad(t.get_sdl_texture(), t.get_pixel_size(), source, dest, angle, center, flip, WHITE);
+        } else {
+            CELERIT_PROFILE_ZONE("renderer::copy_texture");
+            //quads queued with queue_texture or queue_rect come first
+            flush_batch();
+            SDL_RenderCopyEx(rend, t.get_sdl_texture(), &source, &dest, angle, &center, flip);
+            frame_draw_calls++;
+        }
     }
 
-    ~renderer() {
-        SDL_DestroyRenderer(rend);
+    void push_quad(SDL_Texture* tex, ivec2 size, rect source, rect dest, double angle, SDL_Point center, SDL_RendererFlip flip, color tint) {
+        //turns a texture copy into 4 vertices and 6 indices on the batch queue
+        if (size.x <= 0 || size.y <= 0) return;
+
+        //a new texture starts a new run
+        if (batch_runs.empty() || batch_runs.back().tex != tex) {
+            batch_runs.push_back({tex, static_cast<int>(batch_vertices.size()), static_cast<int>(batch_indices.size()), 0});
+        }
+        batch_run& run = batch_runs.back();
+
+        //texture coordinates, flipping is done by swapping them
+        float u1 = static_cast<float>(source.x) / size.x;
+        float v1 = static_cast<float>(source.y) / size.y;
+        float u2 = static_cast<float>(source.x + source.w) / size.x;
+        float v2 = static_cast<float>(source.y + source.h) / size.y;
+        if (flip & SDL_FLIP_HORIZONTAL) std::swap(u1, u2);
+        if (flip & SDL_FLIP_VERTICAL) std::swap(v1, v2);
+
+        float xs[4] = {(float)dest.x, (float)(dest.x + dest.w), (float)(dest.x + dest.w), (float)dest.x};
+        float ys[4] = {(float)dest.y, (float)dest.y, (float)(dest.y + dest.h), (float)(dest.y + dest.h)};
+        float us[4] = {u1, u2, u2, u1};
+        float vs[4] = {v1, v1, v2, v2};
+
+        if (angle != 0.0) {
+            //rotate the corners clockwise around the center (relative to dest) just like SDL_RenderCopyEx does
+            float sa = static_cast<float>(sin(angle * RADIAN_CONVERSION));
+            float ca = static_cast<float>(cos(angle * RADIAN_CONVERSION));
+            float cx = static_cast<float>(dest.x + center.x);
+            float cy = static_cast<float>(dest.y + center.y);
+            for (int i = 0; i < 4; i++) {
+                float dx = xs[i] - cx;
+                float dy = ys[i] - cy;
+                xs[i] = cx + dx*ca - dy*sa;
+                ys[i] = cy + dx*sa + dy*ca;
+            }
+        }
+
+        SDL_Color c = tint;
+        int base = static_cast<int>(batch_vertices.size()) - run.first_vertex;
+        for (int i = 0; i < 4; i++) {
+            batch_vertices.push_back({{xs[i], ys[i]}, c, {us[i], vs[i]}});
+        }
+
+        //two triangles, 0-1-2 and 0-2-3
+        int quad_indices[6] = {base, base+1, base+2, base, base+2, base+3};
+        batch_indices.insert(batch_indices.end(), quad_indices, quad_indices+6);
+        run.quad_count++;
     }
 
 };
@@ -4,13 +4,21 @@
 #include "util.hpp"
 
 
+//pass as the last argument to screen to make a headless screen, see screen::is_headless
+struct headless_t {};
+inline constexpr headless_t HEADLESS = headless_t();
+
+
 /*
 the screen class, essentially a wrapper for an SDL_Window
+a headless screen has no window, it is an offscreen surface that a renderer draws into with the software renderer,
+so drawing works on machines without a display or GPU (see CELERIT_INIT_HEADLESS) and reads back the same every run
 TODO: Make more useful
 */
 class screen {
     private:
-    SDL_Window* win;
+    SDL_Window* win = nullptr;
+    SDL_Surface* surface = nullptr;
     rect screen_rect;
 
     public:
@@ -27,9 +35,33 @@ class screen {
         screen_rect = {0, 0, w, h};
     }
 
+    screen(int w, int h, headless_t) {
+        //create a headless screen, an offscreen 32 bit surface with width, w and height, h
+        surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (surface == nullptr) {
+            cerr << "Error: could not create a headless screen: " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+        screen_rect = {0, 0, w, h};
+    }
+
+    //a screen owns its window, so it cant be copied
+    screen(const screen&) = delete;
+    screen& operator=(const screen&) = delete;
+
     void set_title(string s) {
         //sets the title of the window
-        SDL_SetWindowTitle(win, s.c_str());
+        if (win) SDL_SetWindowTitle(win, s.c_str());
+    }
+
+    bool is_headless() {
+        //returns whether the screen is an offscreen surface rather than a window
+        return surface != nullptr;
+    }
+
+    SDL_Surface* get_sdl_surface() {
+        //returns the surface a headless screen is drawn into, nullptr for a windowed screen
+        return surface;
     }
 
     SDL_Window* get_sdl_window() {
@@ -44,6 +76,7 @@ class screen {
 
     ~screen() {
         if (win) SDL_DestroyWindow(win);
+        if (surface) SDL_FreeSurface(surface);
     }
 };
 
@@ -0,0 +1,89 @@
+#ifndef SIM_CLOCK
+#define SIM_CLOCK
+
+#include "util.hpp"
+#include <algorithm>
+
+
+/*
+A fixed timestep clock for running the simulation at a set rate no matter how fast frames are drawn
+each frame, call sim_clock::begin_frame and then update the simulation once for every sim_clock::tick,
+passing sim_clock::get_dt to anything that takes a dt (emitters, sprite groups)
+
+    clk.begin_frame();
+    while (clk.tick()) {
+        sprites.update(clk.get_dt());
+        emitter.update(clk.get_dt());
+    }
+    //draw, using clk.get_alpha() to blend between the last two simulation states if you want smooth motion
+
+the leftover time that didnt add up to a whole step is carried over to the next frame
+*/
+class sim_clock {
+    private:
+    //the length of one simulation step in seconds
+    seconds_t step;
+    //time that has passed but hasnt been simulated yet
+    seconds_t accumulator = 0;
+    //frames longer than this are cut short so a long stall doesnt make the simulation spiral trying to catch up
+    seconds_t max_frame_time;
+    steady_clock::time_point last_time;
+    unsigned long long tick_count = 0;
+
+    public:
+
+    sim_clock(double hz = 60.0, seconds_t max_frame = 0.25) {
+        //creates a clock that steps <hz> times per second
+        step = 1.0 / hz;
+        max_frame_time = max_frame;
+        last_time = steady_clock::now();
+    }
+
+    void begin_frame() {
+        //adds the real time since the last frame to the accumulator
+        steady_clock::time_point now = steady_clock::now();
+        seconds_t elapsed = duration_cast<nanoseconds>(now - last_time).count() / 1000000000.0L;
+        last_time = now;
+        advance(elapsed);
+    }
+
+    void advance(seconds_t elapsed) {
+        //adds an arbitrary amount of time to the accumulator, useful for replays and tests where real time shouldnt matter
+        accumulator += std::min(elapsed, max_frame_time);
+    }
+
+    bool tick() {
+        //returns true and consumes one step if a whole step of time is waiting to be simulated
+        if (accumulator >= step) {
+            accumulator -= step;
+            tick_count++;
+            return true;
+        }
+        return false;
+    }
+
+    seconds_t get_dt() {
+        //returns the length of one step in seconds
+        return step;
+    }
+
+    double get_alpha() {
+        //returns how far between the last step and the next one we are, from 0 to 1, for interpolating drawing
+        return static_cast<double>(accumulator / step);
+    }
+
+    unsigned long long get_ticks() {
+        //returns how many steps have been simulated in total
+        return tick_count;
+    }
+
+    void reset() {
+        //throws away any unsimulated time and starts timing from now
+        accumulator = 0;
+        tick_count = 0;
+        last_time = steady_clock::now();
+    }
+};
+
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef SPATIAL_GRID
+#define SPATIAL_GRID
+
+#include "util.hpp"
+#include <vector>
+
+
+/*
+A uniform grid broadphase for rects, space is split into square cells and every rect is binned into each cell it touches,
+so a query only has to test the rects in the cells it overlaps rather than every rect there is
+cells are hashed so the grid has no bounds, and only cells with something in them take up memory
+
+the grid stores pointers, if a rect moves the grid has to be told with spatial_grid::update,
+which only does work if the rect crossed into different cells
+*/
+class spatial_grid {
+    private:
+    //the cells a rect covers, inclusive
+    struct cell_range {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+
+        bool operator ==(const cell_range& other) const {
+            return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+        }
+    };
+
+    struct entry {
+        rect* r;
+        cell_range cells;
+        //the last query that looked at this entry, so rects in more than one cell are only tested once per query
+        unsigned int stamp;
+    };
+
+    int cell_size;
+    //entries are referred to by slot, removed slots are reused
+    std::vector<entry> entries;
+    std::vector<int> free_slots;
+    unordered_map<rect*, int> slot_of;
+    unordered_map<int64_t, std::vector<int>> cells;
+    unsigned int query_stamp = 0;
+
+
+    static int64_t cell_key(int cx, int cy) {
+        //shifted as unsigned, shifting a negative cx left is undefined
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy));
+    }
+
+    int to_cell(int v) const {
+        //floor division so negative coordinates land in the right cell
+        return v >= 0 ? v / cell_size : -((-v + cell_size - 1) / cell_size);
+    }
+
+    cell_range get_cells(const rect& r) const {
+        //collide_rect counts touching edges as colliding, so the far edge is included
+        return {to_cell(r.x), to_cell(r.y), to_cell(r.x + r.w), to_cell(r.y + r.h)};
+    }
+
+    void bin(int slot) {
+        cell_range& c = entries[slot].cells;
+        for (int cx = c.x0; cx <= c.x1; cx++) {
+            for (int cy = c.y0; cy <= c.y1; cy++) {
+                cells[cell_key(cx, cy)].push_back(slot);
+            }
+        }
+    }
+
+    void unbin(int slot) {
+        cell_range& c = entries[slot].cells;
+        for (int cx = c.x0; cx <= c.x1; cx++) {
+            for (int cy = c.y0; cy <= c.y1; cy++) {
+                auto found = cells.find(cell_key(cx, cy));
+                if (found == cells.end()) continue;
+
+                std::vector<int>& cell = found->second;
+                for (size_t i = 0; i < cell.size(); i++) {
+                    if (cell[i] == slot) {
+                        cell[i] = cell.back();
+                        cell.pop_back();
+                        break;
+                    }
+                }
+                if (cell.empty()) cells.erase(found);
+            }
+        }
+    }
+
+    unsigned int next_stamp() {
+        //starts a new query, if the stamp wraps around every entry is reset so old stamps cant match
+        if (++query_stamp == 0) {
+            for (entry& e: entries) e.stamp = 0;
+            query_stamp = 1;
+        }
+        return query_stamp;
+    }
+
+    public:
+
+    spatial_grid(int cell_size = 64) {
+        //creates an empty grid with square cells of <cell_size> pixels
+        this->cell_size = cell_size > 0 ? cell_size : 1;
+    }
+
+    void insert(rect* r) {
+        //adds a rect to the grid, adding the same rect twice does nothing
+        if (slot_of.find(r) != slot_of.end()) return;
+
+        int slot;
+        if (!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            slot = static_cast<int>(entries.size());
+            entries.push_back({});
+        }
+
+        entries[slot] = {r, get_cells(*r), 0};
+        slot_of[r] = slot;
+        bin(slot);
+    }
+
+    void remove(rect* r) {
+        //takes a rect out of the grid
+        auto found = slot_of.find(r);
+        if (found == slot_of.end()) return;
+
+        int slot = found->second;
+        unbin(slot);
+        entries[slot].r = nullptr;
+        free_slots.push_back(slot);
+        slot_of.erase(found);
+    }
+
+    void update(rect* r) {
+        //rebins a rect after it moved or changed size, only touches the grid if it ended up in different cells
+        auto found = slot_of.find(r);
+        if (found == slot_of.end()) return;
+
+        int slot = found->second;
+        cell_range now = get_cells(*r);
+        if (now == entries[slot].cells) return;
+
+        unbin(slot);
+        entries[slot].cells = now;
+        bin(slot);
+    }
+
+    void clear() {
+        //removes every rect
+        entries.clear();
+        free_slots.clear();
+        slot_of.clear();
+        cells.clear();
+    }
+
+    void set_cell_size(int size) {
+        //changes the size of the cells and rebins everything
+        cell_size = size > 0 ? size : 1;
+        cells.clear();
+        for (size_t slot = 0; slot < entries.size(); slot++) {
+            if (entries[slot].r == nullptr) continue;
+            entries[slot].cells = get_cells(*entries[slot].r);
+            bin(static_cast<int>(slot));
+        }
+    }
+
+    int get_cell_size() {
+        return cell_size;
+    }
+
+    int size() {
+        //returns how many rects are in the grid
+        return static_cast<int>(slot_of.size());
+    }
+
+    template<typename F>
+    bool for_each_overlapping(const rect& area, F&& func) {
+        /*
+        calls func(rect*) for every rect in the grid that collides with area, each rect at most once
+        if func returns true the query stops early, and so does this function (returning true)
+        */
+        unsigned int stamp = next_stamp();
+        cell_range c = get_cells(area);
+
+        for (int cx = c.x0; cx <= c.x1; cx++) {
+            for (int cy = c.y0; cy <= c.y1; cy++) {
+                auto found = cells.find(cell_key(cx, cy));
+                if (found == cells.end()) continue;
+
+                for (int slot: found->second) {
+                    entry& e = entries[slot];
+                    if (e.stamp == stamp) continue;
+                    e.stamp = stamp;
+
+                    if (collide_rect(*e.r, area) && func(e.r)) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void query_rect(const rect& area, std::vector<rect*>& out) {
+        //appends every rect that collides with area to out
+        for_each_overlapping(area, [&out](rect* r) {
+            out.push_back(r);
+            return false;
+        });
+    }
+
+    void query_point(ivec2 point, std::vector<rect*>& out) {
+        //appends every rect that contains the point to out
+        query_rect(rect{{point.x, point.y, 0, 0}}, out);
+    }
+};
+
+
+#endif
@@ -4,6 +4,10 @@
 #include "CeleritObject.hpp"
 #include "renderer.hpp"
 #include "level.hpp"
+#include "texture_atlas.hpp"
+#include "aabb_tree.hpp"
+#include "job_system.hpp"
+#include "render_snapshot.hpp"
 #include <unordered_set>
 
 //Sprite class: contains basic functions for position, collision, and includes a renderer pointer
@@ -12,6 +16,9 @@ class sprite : public CObject {
     renderer* rend;
     dvec2 position;
     rect collision;
+    //the tree the collision rect is registered with, if any, and its proxy in that tree
+    aabb_tree* collision_tree = nullptr;
+    int collision_proxy = -1;
 
     public:
     sprite(renderer& r) : CObject() {
@@ -29,6 +36,29 @@ class sprite : public CObject {
         rend = &r;
     }
 
+    sprite(const sprite& other) : CObject(other) {
+        //copies everything but the collision registration, a tree proxy belongs to one sprite
+        rend = other.rend;
+        position = other.position;
+        collision = other.collision;
+    }
+
+    sprite& operator=(const sprite& other) {
+        //keeps this sprites own registration, which now tracks the copied rect
+        if (this == &other) return *this;
+        CObject::operator=(other);
+        rend = other.rend;
+        position = other.position;
+        collision = other.collision;
+        update_collision();
+        return *this;
+    }
+
+    virtual ~sprite() {
+        //the tree points at this sprite, so it has to be taken out before it is freed
+        unregister_collision();
+    }
+
     dvec2 get_pos() {
         //returns the position
         return position;
@@ -53,13 +83,41 @@ class sprite : public CObject {
     }
 
     virtual void draw() {/*override to add drawing funtionality*/};
+    virtual void capture(render_snapshot&, dvec2 = {0, 0}) {/*override to add what the sprite draws to a snapshot, see frame_pipeline, sprites that dont are invisible in pipelined frames*/};
     virtual void update() {/*override for updating your sprite*/};
+    virtual void fixed_update(seconds_t) {
+        //override for updating your sprite by a fixed timestep (see sim_clock), falls back on sprite::update()
+        update();
+    };
 
     
 
     virtual bool isColliding(rect other) {
         return collide_rect(collision, other);
     }
+
+    void register_collision(aabb_tree& tree) {
+        /*
+        registers the collision rect with a tree, the sprite is the user data so pairs from aabb_tree::find_pairs can be cast back to sprite*
+        the tree keeps a pointer to the rect, so only register once the sprite is where it will stay (for example after sprite_group::create_sprite)
+        copies of the sprite arent registered, and the sprite unregisters itself when destroyed, so the tree has to outlive it
+        */
+        unregister_collision();
+        collision_tree = &tree;
+        collision_proxy = tree.insert(&collision, this);
+    }
+
+    void unregister_collision() {
+        //removes the collision rect from its tree
+        if (collision_tree != nullptr) collision_tree->remove(collision_proxy);
+        collision_tree = nullptr;
+        collision_proxy = -1;
+    }
+
+    void update_collision() {
+        //tells the tree the collision rect moved, call after changing the collision rect
+        if (collision_tree != nullptr) collision_tree->update(collision_proxy);
+    }
 };
 
 
@@ -67,11 +125,17 @@ class sprite : public CObject {
 class prop : public sprite {
     protected:
     texture text;
+    //keeps the cached texture alive, props loading the same file share one texture
+    renderer::texture_handle text_handle;
+    //set when the prop is drawn from a texture_atlas, then text is the atlas page and source is where on it the image is
+    bool use_source = false;
+    rect source = {{0, 0, 0, 0}};
 
     public:
     
     prop(renderer& r, const char* file) : sprite(r) {
-        text = texture(r, file);
+        text_handle = r.load_texture(file);
+        text = text_handle;
         position = {0, 0};
         obj_name = "prop";
         collision = text.get_rect();
@@ -79,7 +143,8 @@ class prop : public sprite {
 
     template<typename T = int, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
     prop(renderer& r, const char* file, v2<T> pos) : sprite(r, pos) {
-        text = texture(r, file);
+        text_handle = r.load_texture(file);
+        text = text_handle;
         position = {pos.x, pos.y};
         obj_name = "prop";
         collision = text.get_rect();
@@ -87,8 +152,35 @@ class prop : public sprite {
         collision.y = pos.y;
     }
 
+    template<typename T = int, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+    prop(renderer& r, atlas_region region, v2<T> pos) : sprite(r, pos) {
+        //creates a prop drawn from an image packed into a texture_atlas, so props sharing an atlas page batch together
+        text = region.get_texture();
+        use_source = true;
+        source = region.get_source();
+        position = {pos.x, pos.y};
+        obj_name = "prop";
+        collision = {{static_cast<int>(pos.x), static_cast<int>(pos.y), source.w, source.h}};
+    }
+
     virtual void draw(level& l) {
-        rend->blit_texture(text, dvec2{position.x - l.get_scroll().x, position.y - l.get_scroll().y}.convert_data<int>());
+        ivec2 screen_pos = dvec2{position.x - l.get_scroll().x, position.y - l.get_scroll().y}.convert_data<int>();
+        if (use_source) {
+            rend->blit_texture(text, source, rect{{screen_pos.x, screen_pos.y, source.w, source.h}});
+        } else {
+            rend->blit_texture(text, screen_pos);
+        }
+    }
+
+    void capture(render_snapshot& snap, dvec2 scroll = {0, 0}) override {
+        //adds the same quad prop::draw would draw to a snapshot
+        ivec2 screen_pos = dvec2{position.x - scroll.x, position.y - scroll.y}.convert_data<int>();
+        if (use_source) {
+            snap.add(text, source, rect{{screen_pos.x, screen_pos.y, source.w, source.h}});
+        } else {
+            rect r = text.get_rect();
+            snap.add(text, r, rect{{screen_pos.x, screen_pos.y, r.w, r.h}});
+        }
     }
 
     texture& get_texture() {
@@ -110,14 +202,8 @@ class sprite_group {
 
     template<typename T, typename = std::enable_if_t<std::is_base_of_v<sprite, T>>>
     T* create_sprite(T instance) {
-        //raw pointers because new is too powerful for such cases
-        T* Sprite = (T*)malloc(sizeof(T));
-        memcpy(Sprite, &instance, sizeof(T));
-
-        if (Sprite == nullptr) {
-            cerr << "Error creating sprite instance!";
-            exit(-1);
-        }
+        //moved rather than copied bytewise, so members like strings and texture handles stay valid
+        T* Sprite = new T(std::move(instance));
 
         sprites.push_back(Sprite);
         return Sprite;
@@ -126,7 +212,7 @@ class sprite_group {
     template<typename T, typename = std::enable_if_t<std::is_base_of_v<sprite, T>>>
     void destroy_sprite(T** Sprite) {
         sprites.erase(std::find(sprites.begin(), sprites.end(), *Sprite));
-        free(*Sprite);
+        delete *Sprite;
         *Sprite = nullptr;
     }
 
@@ -136,15 +222,42 @@ class sprite_group {
         }
     }
 
+    void capture(render_snapshot& snap, dvec2 scroll = {0, 0}) {
+        //adds every sprite to a snapshot, in the same order sprite_group::draw draws them
+        for (sprite* s: sprites) {
+            s->capture(snap, scroll);
+        }
+    }
+
     void update() {
         for (sprite* s: sprites) {
             s->update();
         }
     }
 
+    void update(seconds_t dt) {
+        //updates every sprite by a fixed timestep through sprite::fixed_update, see sim_clock
+        for (sprite* s: sprites) {
+            s->fixed_update(dt);
+        }
+    }
+
+    void update(seconds_t dt, job_system& jobs, int chunk_size = 64) {
+        /*
+        updates every sprite by a fixed timestep spread across the job systems workers, in chunks of chunk_size sprites
+        sprites are updated in no particular order and at the same time, so an update can only touch its own sprite
+        (anything shared, like level collision queries or a renderer, has to be done before or after)
+        */
+        jobs.parallel_for(0, static_cast<int>(sprites.size()), [this, dt](int first, int last) {
+            for (int i = first; i < last; i++) {
+                sprites[i]->fixed_update(dt);
+            }
+        }, chunk_size);
+    }
+
     ~sprite_group() {
         for (sprite* sp: sprites) {
-            if (sp) free(sp);
+            delete sp;
         }
     }
 
@@ -4,8 +4,10 @@
 #include "util.hpp"
 #include "renderer.hpp"
 #include "sstream"
+#include <charconv>
 #include <iomanip>
 #include <map>
+#include <string_view>
 
 //Flags
 namespace tstream {
@@ -41,6 +43,94 @@ class text_stream {
     ivec2 buffer_offset = {0, 0};
     color Color;
     std::unordered_map<uint32_t, tstream::flag> flags = unordered_map<uint32_t, tstream::flag>();
+
+    //a single line of text written to the stream, kept between frames along with its layout
+    struct text_run {
+        string text;
+        font* fnt;
+        int font_size;
+        int atlas_generation;
+        text_layout layout;
+        ivec2 offset;
+        color col;
+    };
+
+    //the retained layout, runs are matched up by the order they are written in each frame
+    //so a run only gets laid out again when its text or font changed since the last frame
+    std::vector<text_run> runs;
+    int run_count = 0;
+
+
+    ivec2 add_run(std::string_view line) {
+        //adds a line at the current offset, laying it out only if it changed, and returns its size
+        if (line.empty()) return {0, 0};
+
+        if (run_count == static_cast<int>(runs.size())) runs.emplace_back();
+        text_run& run = runs[run_count++];
+
+        if (run.text != line || run.fnt != Font || run.font_size != Font->get_size() || run.atlas_generation != Font->get_atlas_generation()) {
+            run.text.assign(line.data(), line.size());
+            run.fnt = Font;
+            run.font_size = Font->get_size();
+            Font->layout_text(rend->get_sdl_renderer(), run.text, true, run.layout);
+            //laying out can rasterize glyphs which can clear the atlas, so read the generation afterwards
+            run.atlas_generation = Font->get_atlas_generation();
+        }
+
+        run.offset = pos.convert_data<int>() + current_offset;
+        run.col = Color;
+        return run.layout.size;
+    }
+
+    text_stream& write(std::string_view s) {
+        //lays out a string of text, nothing is drawn until text_stream::flush
+        size_t start = 0;
+        ivec2 offset = {0, 0};
+
+        if (s.length() > 0 && s[0] == '\n') {
+            current_offset.y += buffer_offset.y;
+
+        }
+
+        for (size_t i = 0; i < s.length(); i++) {
+            if (s[i] == '\n') {
+                offset = add_run(s.substr(start, i-start));
+                start = i+1;
+                current_offset.y += offset.y + 10;
+                current_offset.x = 0;
+            }
+        }
+        offset = add_run(s.substr(start));
+        current_offset.x += offset.x;
+        
+        buffer_offset = offset;
+        return *this;
+    }
+
+    template<typename T>
+    text_stream& write_integer(T i) {
+        //formats an integer on the stack rather than through a string
+        char buf[24];
+        std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), i);
+        return write(std::string_view(buf, res.ptr - buf));
+    }
+
+    template<typename T>
+    text_stream& write_floating(T i) {
+        //formats a floating point number on the stack, the TRUNCATE flag sets the number of decimal places
+        //without it, numbers come out the same way an unmodified std::ostream would print them
+        char buf[128];
+        std::to_chars_result res;
+        if (flags[tstream::TRUNCATE.bin_flag].bin_flag != 0 && flags[1].value != -1) {
+            res = std::to_chars(buf, buf + sizeof(buf), i, std::chars_format::fixed, flags[1].value);
+            //too big to print in fixed notation, fall back on scientific
+            if (res.ec != std::errc()) res = std::to_chars(buf, buf + sizeof(buf), i, std::chars_format::scientific, flags[1].value);
+        } else {
+            res = std::to_chars(buf, buf + sizeof(buf), i, std::chars_format::general, 6);
+        }
+        if (res.ec != std::errc()) return *this;
+        return write(std::string_view(buf, res.ptr - buf));
+    }
     
 
 
@@ -77,92 +167,60 @@ class text_stream {
 
     text_stream& operator << (string s) {
         //renders a string of text
-        int start = 0;
-        ivec2 offset = {0, 0};
-
-        if (s.length() > 0 && s[0] == '\n') {
-            current_offset.y += buffer_offset.y;
-
-        }
-
-        for (int i = 0; i < s.length(); i++) {
-            if (s[i] == '\n') {
-                offset = rend->render_aatext(*Font, s.substr(start, i-start), (pos.convert_data<int>()+current_offset), Color);
-                start = i+1;
-                current_offset.y += offset.y + 10;
-                current_offset.x = 0;
-            }
-        }
-        offset = rend->render_aatext(*Font, s.substr(start), (pos.convert_data<int>()+current_offset), Color);
-        current_offset.x += offset.x;
-        
-        buffer_offset = offset;
-        return *this;
+        return write(s);
     }
 
     text_stream& operator << (std::stringstream ss) {
         //renders a string stream as text
-        return (*this << ss.str());
+        return write(ss.str());
     }
 
     text_stream& operator << (int i) {
         //renders an int as text
-        return (*this << std::to_string(i));
+        return write_integer(i);
     }
 
     text_stream& operator << (unsigned int i) {
         //renders a unsigned int as text
-        return (*this << std::to_string(i));
+        return write_integer(i);
     }
 
     text_stream& operator << (long long i) {
         //renders a long long as text
-        return (*this << std::to_string(i));
+        return write_integer(i);
     }
 
     text_stream& operator << (unsigned long long i) {
         //renders a unsigned long long as text
-        return (*this << std::to_string(i));
+        return write_integer(i);
     }
 
     text_stream& operator << (long i) {
         //renders a long as text
-        return (*this << std::to_string(i));
+        return write_integer(i);
     }
 
 
     text_stream& operator << (unsigned long i) {
         //renders a unsigned long as text
-        return (*this << std::to_string(i));
+        return write_integer(i);
     }
 
 
 
     text_stream& operator << (float i) {
         //renders a float as text, use the TS::TRUNCATE flag to truncate the value
-        std::stringstream db;
-        if (flags[tstream::TRUNCATE.bin_flag].bin_flag != 0 && flags[1].value != -1) {
-            db << std::fixed << std::setprecision(flags[1].value) << i;
-        }
-        return (*this << db.str());
+        return write_floating(i);
     }
 
     text_stream& operator << (double i) {
         //renders a double as text, use the TS::TRUNCATE flag to truncate the value
-        std::stringstream db;
-        if (flags[tstream::TRUNCATE.bin_flag].bin_flag != 0 && flags[1].value != -1) {
-            db << std::fixed << std::setprecision(flags[1].value) << i;
-        }
-        return (*this << db.str());
+        return write_floating(i);
     }
 
     text_stream& operator << (long double i) {
         //renders a double as text, use the TS::TRUNCATE flag to truncate the value
-        std::stringstream db;
-        if (flags[tstream::TRUNCATE.bin_flag].bin_flag != 0 && flags[1].value != -1) {
-            db << std::fixed << std::setprecision(flags[1].value) << i;
-        }
-        return (*this << db.str());
+        return write_floating(i);
     }
 
     text_stream& operator << (rect r) {
@@ -186,7 +244,15 @@ class text_stream {
     void flush() {
         /*
         presents all text, resets the offsets and flags
+        everything written since the last flush goes to the renderer as a single batch
         */
+        for (int i = 0; i < run_count; i++) {
+            text_run& run = runs[i];
+            rend->queue_text(*run.fnt, run.layout, run.offset, run.col);
+        }
+        if (!rend->get_batching()) rend->flush_batch();
+        run_count = 0;
+
         current_offset = {0, 0};
         for (int i = 1; i < 32; i = i*2) {
             flags[i] = tstream::fNULL;
@@ -0,0 +1,249 @@
+#ifndef TEXTURE_ATLAS
+#define TEXTURE_ATLAS
+
+#include "util.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+
+//a packed image inside a texture_atlas, draw it with renderer::blit_texture(region.get_texture(), region.get_source(), dest)
+struct atlas_region {
+    //a copy of the atlas page the image was packed into, owned by the atlas
+    texture page;
+    //where on the page the image is
+    rect source = {{0, 0, 0, 0}};
+    int page_index = -1;
+
+    bool is_null() const {
+        return page_index < 0;
+    }
+
+    texture& get_texture() {
+        return page;
+    }
+
+    rect get_source() const {
+        return source;
+    }
+};
+
+
+/*
+Packs lots of small images into a few large textures, so props and particles that use them can be drawn in one batch
+images are placed with a skyline packer (bottom left first), when a page is full a new page is started,
+images bigger than a page get a page of their own
+
+    texture_atlas atlas(rend);
+    atlas_region tree = atlas.add("tree.png");
+    rend.blit_texture(tree.get_texture(), tree.get_source(), dest);
+
+pages are never moved or resized, so regions stay valid for as long as the atlas is alive
+*/
+class texture_atlas {
+    private:
+    //one step of the skyline, the top of the packed images from x to x+w is at y
+    struct skyline_node {
+        int x;
+        int y;
+        int w;
+    };
+
+    struct page {
+        texture tex;
+        int w;
+        int h;
+        std::vector<skyline_node> skyline;
+        //pixels covered by packed images, padding included
+        long long used_area = 0;
+    };
+
+    renderer* rend;
+    int page_size;
+    //empty pixels left between images so linear filtering doesnt bleed neighbours into eachother
+    int padding;
+    std::vector<page> pages;
+    unordered_map<string, atlas_region> regions;
+
+    void add_page(int w, int h) {
+        //creates a new empty page, static textures start out undefined so it gets cleared to transparent
+        SDL_Texture* tex = SDL_CreateTexture(rend->get_sdl_renderer(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, w, h);
+        if (tex == nullptr) {
+            cerr << "Error: could not create an atlas page: " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        std::vector<Uint32> clear(static_cast<size_t>(w) * h, 0);
+        SDL_UpdateTexture(tex, nullptr, clear.data(), w * 4);
+
+        page p;
+        p.tex = texture(tex);
+        p.w = w;
+        p.h = h;
+        p.skyline.push_back({0, 0, w});
+        pages.push_back(std::move(p));
+    }
+
+    static int fit(const page& p, int index, int w, int h) {
+        //returns the y an image of size w*h would sit at if its left edge was at skyline node <index>, or -1 if it doesnt fit
+        int x = p.skyline[index].x;
+        if (x + w > p.w) return -1;
+        int y = 0;
+        int width_left = w;
+        for (int i = index; width_left > 0; i++) {
+            y = std::max(y, p.skyline[i].y);
+            if (y + h > p.h) return -1;
+            width_left -= p.skyline[i].w;
+        }
+        return y;
+    }
+
+    static bool pack(page& p, int w, int h, ivec2& out) {
+        //finds the lowest spot for a w*h image and raises the skyline over it
+        int best_index = -1;
+        int best_top = INT_MAX;
+        int best_width = INT_MAX;
+        int best_y = 0;
+        for (int i = 0; i < (int)p.skyline.size(); i++) {
+            int y = fit(p, i, w, h);
+            if (y < 0) continue;
+            //prefer the lowest top edge, then the narrowest step so wide gaps are kept for wide images
+            if (y + h < best_top || (y + h == best_top && p.skyline[i].w < best_width)) {
+                best_index = i;
+                best_top = y + h;
+                best_width = p.skyline[i].w;
+                best_y = y;
+            }
+        }
+        if (best_index < 0) return false;
+
+        out = {p.skyline[best_index].x, best_y};
+        p.skyline.insert(p.skyline.begin() + best_index, {out.x, best_y + h, w});
+
+        //the new step covers the start of the ones after it, trim or remove them
+        for (size_t i = best_index + 1; i < p.skyline.size(); i++) {
+            skyline_node& prev = p.skyline[i - 1];
+            skyline_node& cur = p.skyline[i];
+            int overlap = prev.x + prev.w - cur.x;
+            if (overlap <= 0) break;
+            cur.x += overlap;
+            cur.w -= overlap;
+            if (cur.w > 0) break;
+            p.skyline.erase(p.skyline.begin() + i);
+            i--;
+        }
+
+        //join neighbouring steps that ended up at the same height
+        for (size_t i = 0; i + 1 < p.skyline.size(); i++) {
+            if (p.skyline[i].y == p.skyline[i + 1].y) {
+                p.skyline[i].w += p.skyline[i + 1].w;
+                p.skyline.erase(p.skyline.begin() + i + 1);
+                i--;
+            }
+        }
+
+        p.used_area += (long long)w * h;
+        return true;
+    }
+
+    public:
+
+    texture_atlas(renderer& r, int page_size = 1024, int padding = 1) {
+        //creates an empty atlas, pages are <page_size>*<page_size> pixels and only created when needed
+        rend = &r;
+        this->page_size = page_size;
+        this->padding = padding;
+    }
+
+    texture_atlas(const texture_atlas&) = delete;
+    texture_atlas& operator=(const texture_atlas&) = delete;
+
+    atlas_region add(const string& file) {
+        //loads an image file into the atlas, adding the same file twice returns the region it already has
+        auto found = regions.find(file);
+        if (found != regions.end()) return found->second;
+
+        SDL_Surface* surf = IMG_Load(file.c_str());
+        if (surf == nullptr) {
+            cerr << "Error: could not load " << file << " into the atlas: " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+        atlas_region region = add(file, surf);
+        SDL_FreeSurface(surf);
+        return region;
+    }
+
+    atlas_region add(const string& name, SDL_Surface* surf) {
+        //packs a surface into the atlas under <name>, the surface isnt freed, if the name is taken the old region is returned
+        auto found = regions.find(name);
+        if (found != regions.end()) return found->second;
+
+        //pixels are copied straight into the page, so they have to be in the same format as it
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (converted == nullptr) {
+            cerr << "Error: could not convert " << name << " for the atlas: " << SDL_GetError() << "\n";
+            exit(-1);
+        }
+
+        int w = converted->w + padding;
+        int h = converted->h + padding;
+        ivec2 pos = {0, 0};
+        int page_index = -1;
+        for (int i = 0; i < (int)pages.size(); i++) {
+            if (pack(pages[i], w, h, pos)) {
+                page_index = i;
+                break;
+            }
+        }
+        if (page_index < 0) {
+            //spill into a new page, sized to fit the image if it is bigger than a normal page
+            add_page(std::max(page_size, w), std::max(page_size, h));
+            page_index = (int)pages.size() - 1;
+            pack(pages.back(), w, h, pos);
+        }
+
+        rect source = {{pos.x, pos.y, converted->w, converted->h}};
+        SDL_UpdateTexture(pages[page_index].tex.get_sdl_texture(), &source, converted->pixels, converted->pitch);
+        SDL_FreeSurface(converted);
+
+        atlas_region region;
+        region.page = pages[page_index].tex;
+        region.source = source;
+        region.page_index = page_index;
+        regions[name] = region;
+        return region;
+    }
+
+    atlas_region get(const string& name) {
+        //returns the region added under <name>, or a null region if there isnt one
+        auto found = regions.find(name);
+        if (found == regions.end()) return atlas_region();
+        return found->second;
+    }
+
+    bool contains(const string& name) {
+        return regions.find(name) != regions.end();
+    }
+
+    int get_page_count() {
+        return (int)pages.size();
+    }
+
+    texture& get_page(int index) {
+        return pages[index].tex;
+    }
+
+    double get_page_occupancy(int index) {
+        //the fraction of a page covered by images (padding included), from 0 to 1
+        const page& p = pages[index];
+        return (double)p.used_area / ((double)p.w * p.h);
+    }
+
+    ~texture_atlas() {
+        for (page& p: pages) rend->destroy_texture(p.tex);
+    }
+};
+
+
+#endif
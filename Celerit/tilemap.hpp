@@ -0,0 +1,285 @@
+#ifndef TILEMAP
+#define TILEMAP
+
+#include "util.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <vector>
+
+
+/*
+A tile layer, tiles are indexes into a tileset texture (laid out left to right, top to bottom) and -1 is an empty tile
+tiles are stored in square chunks of CHUNK_TILES x CHUNK_TILES, only chunks that have had a tile set exist
+every chunk is pre-rendered into its own texture, so drawing the map is one blit per visible chunk,
+and a chunk is only rendered again after one of its tiles changes
+
+tiles can be marked solid with tilemap::set_solid, collision is then read straight out of the tiles
+and merged into as few rects as possible per chunk for tilemap::query_rect
+*/
+class tilemap {
+    public:
+    static constexpr int CHUNK_TILES = 16;
+
+    private:
+    struct chunk {
+        std::vector<int> tiles;
+        texture tex;
+        bool has_texture = false;
+        //the texture is out of date
+        bool dirty = true;
+        //solid tiles merged into rects, in world coordinates
+        std::vector<rect> collision;
+        bool collision_dirty = true;
+        //how many tiles in the chunk arent empty
+        int tile_count = 0;
+    };
+
+    renderer* rend;
+    texture tileset;
+    int tile_size;
+    int tileset_columns;
+    unordered_map<int64_t, chunk> chunks;
+    //indexed by tile id
+    std::vector<bool> solid;
+    int chunks_rendered = 0;
+
+
+    static int64_t chunk_key(int cx, int cy) {
+        //shifted as unsigned, shifting a negative cx left is undefined
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy));
+    }
+
+    static int floor_div(int v, int d) {
+        return v >= 0 ? v / d : -((-v + d - 1) / d);
+    }
+
+    int chunk_pixels() const {
+        return CHUNK_TILES * tile_size;
+    }
+
+    chunk* find_chunk(int cx, int cy) {
+        auto found = chunks.find(chunk_key(cx, cy));
+        return found == chunks.end() ? nullptr : &found->second;
+    }
+
+    void render_chunk(chunk& c) {
+        //draws every tile of the chunk into its texture
+        if (!c.has_texture) {
+            c.tex = texture(*rend, chunk_pixels(), chunk_pixels());
+            c.has_texture = true;
+        }
+
+        //the tilemap might be drawn into a texture itself, so whatever was being drawn to is put back afterwards
+        renderer::target_state previous = rend->save_target();
+        rend->set_render_target(c.tex);
+        rend->fill(EMPTY);
+        for (int i = 0; i < CHUNK_TILES * CHUNK_TILES; i++) {
+            int id = c.tiles[i];
+            if (id < 0) continue;
+            rect src = {(id % tileset_columns) * tile_size, (id / tileset_columns) * tile_size, tile_size, tile_size};
+            rect dest = {(i % CHUNK_TILES) * tile_size, (i / CHUNK_TILES) * tile_size, tile_size, tile_size};
+            rend->blit_texture(tileset, src, dest);
+        }
+        rend->restore_target(previous);
+
+        c.dirty = false;
+        chunks_rendered++;
+    }
+
+    void build_collision(int cx, int cy, chunk& c) {
+        /*
+        merges the solid tiles of a chunk into rects, first into horizontal runs on each row,
+        then runs that line up exactly with a run on the row above are merged into it
+        */
+        c.collision.clear();
+        c.collision_dirty = false;
+
+        int origin_x = cx * chunk_pixels();
+        int origin_y = cy * chunk_pixels();
+        //the index in c.collision of the rect each run on the previous row ended up in
+        std::vector<std::pair<int, int>> prev_runs;
+        std::vector<int> prev_rects;
+        std::vector<std::pair<int, int>> runs;
+        std::vector<int> run_rects;
+
+        for (int ty = 0; ty < CHUNK_TILES; ty++) {
+            runs.clear();
+            run_rects.clear();
+
+            int tx = 0;
+            while (tx < CHUNK_TILES) {
+                if (!is_solid_id(c.tiles[ty * CHUNK_TILES + tx])) {
+                    tx++;
+                    continue;
+                }
+                int start = tx;
+                while (tx < CHUNK_TILES && is_solid_id(c.tiles[ty * CHUNK_TILES + tx])) tx++;
+                runs.push_back({start, tx});
+
+                //does it line up with a run on the row above
+                int merged = -1;
+                for (size_t i = 0; i < prev_runs.size(); i++) {
+                    if (prev_runs[i].first == start && prev_runs[i].second == tx) {
+                        merged = prev_rects[i];
+                        break;
+                    }
+                }
+
+                if (merged != -1) {
+                    c.collision[merged].h += tile_size;
+                } else {
+                    merged = static_cast<int>(c.collision.size());
+                    c.collision.push_back({{origin_x + start * tile_size, origin_y + ty * tile_size, (tx - start) * tile_size, tile_size}});
+                }
+                run_rects.push_back(merged);
+            }
+
+            std::swap(prev_runs, runs);
+            std::swap(prev_rects, run_rects);
+        }
+    }
+
+    bool is_solid_id(int id) const {
+        return id >= 0 && id < static_cast<int>(solid.size()) && solid[id];
+    }
+
+    public:
+
+    tilemap(renderer& r, texture tileset_texture, int tile_size) {
+        //creates an empty tilemap, tile_size is the width and height of a tile in pixels, in the tileset and on screen
+        rend = &r;
+        tileset = tileset_texture;
+        this->tile_size = tile_size;
+        tileset_columns = std::max(1, tileset.get_pixel_size().x / tile_size);
+    }
+
+    tilemap(const tilemap&) = delete;
+    tilemap& operator=(const tilemap&) = delete;
+
+    void set_tile(int tx, int ty, int id) {
+        //sets the tile at tile coordinates tx, ty, use -1 to clear it
+        int cx = floor_div(tx, CHUNK_TILES);
+        int cy = floor_div(ty, CHUNK_TILES);
+        chunk* c = find_chunk(cx, cy);
+        if (c == nullptr) {
+            if (id < 0) return;
+            c = &chunks[chunk_key(cx, cy)];
+            c->tiles.assign(CHUNK_TILES * CHUNK_TILES, -1);
+        }
+
+        int& tile = c->tiles[(ty - cy * CHUNK_TILES) * CHUNK_TILES + (tx - cx * CHUNK_TILES)];
+        if (tile == id) return;
+        c->tile_count += (id >= 0) - (tile >= 0);
+        tile = id;
+        c->dirty = true;
+        c->collision_dirty = true;
+    }
+
+    int get_tile(int tx, int ty) {
+        //returns the tile at tile coordinates tx, ty, or -1 if its empty
+        int cx = floor_div(tx, CHUNK_TILES);
+        int cy = floor_div(ty, CHUNK_TILES);
+        chunk* c = find_chunk(cx, cy);
+        if (c == nullptr) return -1;
+        return c->tiles[(ty - cy * CHUNK_TILES) * CHUNK_TILES + (tx - cx * CHUNK_TILES)];
+    }
+
+    void set_solid(int id, bool is_solid = true) {
+        //marks a tile id as solid (or not) for collision
+        if (id < 0) return;
+        if (id >= static_cast<int>(solid.size())) solid.resize(id + 1, false);
+        if (solid[id] == is_solid) return;
+        solid[id] = is_solid;
+        for (auto& [key, c]: chunks) {
+            c.collision_dirty = true;
+        }
+    }
+
+    bool is_solid(int tx, int ty) {
+        //returns whether the tile at tile coordinates tx, ty is solid
+        return is_solid_id(get_tile(tx, ty));
+    }
+
+    void draw(dvec2 scroll) {
+        /*
+        draws every chunk that is on screen with the given scroll, rendering any that changed first
+        chunks are culled against the screen rect as a whole, so off screen chunks cost nothing
+        */
+        rect screen = rend->get_screen_rect();
+        int sx = static_cast<int>(std::floor(scroll.x));
+        int sy = static_cast<int>(std::floor(scroll.y));
+        int cx0 = floor_div(sx, chunk_pixels());
+        int cy0 = floor_div(sy, chunk_pixels());
+        int cx1 = floor_div(sx + screen.w, chunk_pixels());
+        int cy1 = floor_div(sy + screen.h, chunk_pixels());
+
+        for (int cx = cx0; cx <= cx1; cx++) {
+            for (int cy = cy0; cy <= cy1; cy++) {
+                chunk* c = find_chunk(cx, cy);
+                if (c == nullptr || c->tile_count == 0) continue;
+                if (c->dirty) render_chunk(*c);
+
+                rend->blit_texture(c->tex, cx * chunk_pixels() - sx, cy * chunk_pixels() - sy);
+            }
+        }
+    }
+
+    bool is_colliding(const rect& r) {
+        //checks if a rect is touching any solid tile, reads the tiles directly so only the tiles under the rect are looked at
+        //touching counts just like collide_rect, so tiles that end exactly where the rect starts are included
+        int tx0 = floor_div(r.x - 1, tile_size);
+        int ty0 = floor_div(r.y - 1, tile_size);
+        int tx1 = floor_div(r.x + r.w, tile_size);
+        int ty1 = floor_div(r.y + r.h, tile_size);
+
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) {
+                if (is_solid(tx, ty)) return true;
+            }
+        }
+        return false;
+    }
+
+    void query_rect(const rect& area, std::vector<rect*>& out) {
+        //appends the merged collision rects that collide with area to out, the pointers are good until the tiles next change
+        int cx0 = floor_div(area.x - 1, chunk_pixels());
+        int cy0 = floor_div(area.y - 1, chunk_pixels());
+        int cx1 = floor_div(area.x + area.w, chunk_pixels());
+        int cy1 = floor_div(area.y + area.h, chunk_pixels());
+
+        for (int cx = cx0; cx <= cx1; cx++) {
+            for (int cy = cy0; cy <= cy1; cy++) {
+                chunk* c = find_chunk(cx, cy);
+                if (c == nullptr) continue;
+                if (c->collision_dirty) build_collision(cx, cy, *c);
+
+                for (rect& r: c->collision) {
+                    if (collide_rect(r, area)) out.push_back(&r);
+                }
+            }
+        }
+    }
+
+    int get_tile_size() {
+        return tile_size;
+    }
+
+    int get_chunk_count() {
+        //returns how many chunks exist
+        return static_cast<int>(chunks.size());
+    }
+
+    int get_chunks_rendered() {
+        //returns how many times a chunk has been rendered into its texture, for checking that chunks are being cached
+        return chunks_rendered;
+    }
+
+    ~tilemap() {
+        for (auto& [key, c]: chunks) {
+            if (c.has_texture) rend->destroy_texture(c.tex);
+        }
+    }
+};
+
+
+#endif
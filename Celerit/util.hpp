@@ -2,6 +2,7 @@
 #define UTIL
 
 //this file includes includes that every file will use basically
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include "sstream"
@@ -100,6 +101,31 @@ inline bool collide_rect(rect r1, rect r2) {
     return true;
 }
 
+inline bool rect_empty(rect r) {
+    return r.w <= 0 || r.h <= 0;
+}
+
+inline rect union_rect(rect r1, rect r2) {
+    //the smallest rect containing both rects, empty rects are ignored
+    if (rect_empty(r1)) return r2;
+    if (rect_empty(r2)) return r1;
+    int x1 = std::min(r1.x, r2.x);
+    int y1 = std::min(r1.y, r2.y);
+    int x2 = std::max(r1.x + r1.w, r2.x + r2.w);
+    int y2 = std::max(r1.y + r1.h, r2.y + r2.h);
+    return rect{{x1, y1, x2 - x1, y2 - y1}};
+}
+
+inline rect intersect_rect(rect r1, rect r2) {
+    //the area both rects cover, empty ({0, 0, 0, 0}) if they dont overlap
+    int x1 = std::max(r1.x, r2.x);
+    int y1 = std::max(r1.y, r2.y);
+    int x2 = std::min(r1.x + r1.w, r2.x + r2.w);
+    int y2 = std::min(r1.y + r1.h, r2.y + r2.h);
+    if (x2 <= x1 || y2 <= y1) return rect{{0, 0, 0, 0}};
+    return rect{{x1, y1, x2 - x1, y2 - y1}};
+}
+
 inline double rsqrt(double number) {
     //shamelessly stolen from quake
 	long i;
@@ -478,6 +504,23 @@ struct quad {
 
     
     bool is_in(dvec2 point) {
+        //the quad has to be convex (any quad made from a rect is), then the point is inside if it is on the same side of every edge
+        //works for either winding, points on an edge count as inside
+        //a quad with no area (every edge on one line, or a point) has nothing inside it, so nothing counts as in it
+        bool left = false;
+        bool right = false;
+        for (int i = 0; i < 4; i++) {
+            dvec2 a = (*this)[i];
+            dvec2 b = (*this)[(i+1)%4];
+            double cross = (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
+            if (cross < 0) left = true;
+            else if (cross > 0) right = true;
+        }
+        return left != right;
+    }
+
+    bool is_in_concave(dvec2 point) {
+        //the slower ray casting test, for quads that might not be convex
         dline lines[4];
         for (int i = 0; i < 4; i++) {
             lines[i] = {(*this)[i], (*this)[(i+1)%4]};
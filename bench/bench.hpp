@@ -0,0 +1,215 @@
+#ifndef CELERIT_BENCH
+#define CELERIT_BENCH
+
+/*
+a small benchmark harness, so the benchmarks dont need anything but the standard library
+
+    bench::suite s(argc, argv);
+    s.run("v2/normalize", [&](int64_t n) {
+        for (int64_t i = 0; i < n; i++) bench::keep(vecs[i & 1023].normalize());
+    });
+    return s.finish();
+
+every benchmark is handed how many iterations to run and times its own loop, so setup done outside the lambda isnt counted
+the iteration count is grown until a run takes long enough to time, then the benchmark is repeated and the median is reported
+
+    --filter=<text>       only run benchmarks whose name contains text
+    --json=<path>         also write the results as json, for tracking them from commit to commit
+    --min-time=<seconds>  roughly how long each benchmark runs for (default 0.25)
+    --repetitions=<n>     how many timed runs the median is taken from (default 5)
+    --commit=<id>         recorded in the json, defaults to the CELERIT_COMMIT environment variable
+    --<key>=<value>       anything else is kept for the benchmarks to read with suite::get_option
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace bench {
+    template<typename T>
+    inline void keep(T&& value) {
+        //stops the compiler from optimizing away the work that produced value
+        #ifdef _MSC_VER
+        volatile auto* sink = &value;
+        (void)sink;
+        _ReadWriteBarrier();
+        #else
+        asm volatile("" : : "g"(&value) : "memory");
+        #endif
+    }
+
+    struct result {
+        std::string name;
+        int64_t iterations = 0;
+        double ns_per_iter = 0;
+        double min_ns_per_iter = 0;
+        double max_ns_per_iter = 0;
+        //how many things (particles, rects, quads) one iteration handles, for a per item throughput
+        double items_per_iter = 1;
+        std::string skipped;
+    };
+
+    class suite {
+        private:
+        std::string filter;
+        std::string json_path;
+        std::string commit;
+        double min_time = 0.25;
+        int repetitions = 5;
+        std::map<std::string, std::string> options;
+        std::vector<result> results;
+
+        template<typename F>
+        static double time_ns(F& body, int64_t n) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            body(n);
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        static void write_json_string(std::ostream& os, const std::string& s) {
+            os << '"';
+            for (char c: s) {
+                if (c == '"' || c == '\\') os << '\\' << c;
+                else if (static_cast<unsigned char>(c) < 0x20) os << ' ';
+                else os << c;
+            }
+            os << '"';
+        }
+
+        public:
+
+        suite(int argc, char** argv) {
+            //reads the options above from the command line
+            if (const char* env = std::getenv("CELERIT_COMMIT")) commit = env;
+            for (int i = 1; i < argc; i++) {
+                std::string arg = argv[i];
+                if (arg == "--help" || arg == "-h") {
+                    std::cout << "usage: " << argv[0] << " [--filter=text] [--json=path] [--min-time=seconds] [--repetitions=n] [--commit=id] [--key=value]...\n";
+                    std::exit(0);
+                }
+                size_t eq = arg.find('=');
+                if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+                    std::cerr << "Error: unknown argument " << arg << ", options look like --key=value\n";
+                    std::exit(-1);
+                }
+                std::string key = arg.substr(2, eq - 2);
+                std::string value = arg.substr(eq + 1);
+                if (key == "filter") filter = value;
+                else if (key == "json") json_path = value;
+                else if (key == "min-time") min_time = std::max(0.001, std::atof(value.c_str()));
+                else if (key == "repetitions") repetitions = std::max(1, std::atoi(value.c_str()));
+                else if (key == "commit") commit = value;
+                else options[key] = value;
+            }
+        }
+
+        std::string get_option(const std::string& key, const std::string& fallback = "") const {
+            //returns a --key=value option the harness itself doesnt use
+            auto found = options.find(key);
+            return found == options.end() ? fallback : found->second;
+        }
+
+        bool enabled(const std::string& name) const {
+            //whether a benchmark passes the filter, for skipping expensive setup
+            return filter.empty() || name.find(filter) != std::string::npos;
+        }
+
+        template<typename F>
+        void run(const std::string& name, F&& body, double items_per_iter = 1) {
+            //runs body(iterations) until it can be timed reliably, then times it repetitions more times
+            if (!enabled(name)) return;
+
+            //find how many iterations take about a tenth of a repetition
+            double per_rep = min_time / repetitions * 1e9;
+            int64_t n = 1;
+            double t = time_ns(body, n);
+            while (t < per_rep / 10 && n < (int64_t(1) << 40)) {
+                double grow = t <= 0 ? 100 : std::clamp(per_rep / 10 / t * 1.5, 2.0, 100.0);
+                n = static_cast<int64_t>(n * grow);
+                t = time_ns(body, n);
+            }
+            n = std::max<int64_t>(1, static_cast<int64_t>(n * (per_rep / std::max(t, 1.0))));
+
+            std::vector<double> samples;
+            for (int i = 0; i < repetitions; i++) {
+                samples.push_back(time_ns(body, n) / n);
+            }
+            std::sort(samples.begin(), samples.end());
+
+            result r;
+            r.name = name;
+            r.iterations = n;
+            r.ns_per_iter = samples[samples.size() / 2];
+            r.min_ns_per_iter = samples.front();
+            r.max_ns_per_iter = samples.back();
+            r.items_per_iter = items_per_iter;
+            results.push_back(r);
+
+            std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(14) << r.ns_per_iter << " ns/iter" << std::setw(16) << std::setprecision(3)
+                      << items_per_iter / r.ns_per_iter * 1000.0 << " M items/s" << std::setw(12) << n << " iters\n";
+        }
+
+        void skip(const std::string& name, const std::string& reason) {
+            //records that a benchmark couldnt run here, so a missing result doesnt go unnoticed
+            if (!enabled(name)) return;
+            result r;
+            r.name = name;
+            r.skipped = reason;
+            results.push_back(r);
+            std::cout << std::left << std::setw(48) << name << " skipped: " << reason << "\n";
+        }
+
+        int finish() {
+            //writes the json if it was asked for, returns what main should return
+            if (json_path.empty()) return 0;
+
+            std::ofstream out(json_path, std::ios::trunc);
+            if (!out) {
+                std::cerr << "Error: could not open " << json_path << "\n";
+                return -1;
+            }
+
+            char date[32];
+            std::time_t now = std::time(nullptr);
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+            out << std::setprecision(6);
+            out << "{\n  \"context\": {\"date\": \"" << date << "\", \"commit\": ";
+            write_json_string(out, commit);
+            out << ", \"min_time\": " << min_time << ", \"repetitions\": " << repetitions << "},\n  \"benchmarks\": [";
+            for (size_t i = 0; i < results.size(); i++) {
+                const result& r = results[i];
+                out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+                write_json_string(out, r.name);
+                if (!r.skipped.empty()) {
+                    out << ", \"skipped\": ";
+                    write_json_string(out, r.skipped);
+                } else {
+                    out << ", \"iterations\": " << r.iterations << ", \"ns_per_iter\": " << r.ns_per_iter
+                        << ", \"min_ns_per_iter\": " << r.min_ns_per_iter << ", \"max_ns_per_iter\": " << r.max_ns_per_iter
+                        << ", \"items_per_second\": " << r.items_per_iter / r.ns_per_iter * 1e9;
+                }
+                out << "}";
+            }
+            out << "\n  ]\n}\n";
+            return 0;
+        }
+    };
+}
+
+
+#endif
@@ -0,0 +1,339 @@
+/*
+microbenchmarks for the engines hot paths, run headless so they work on build machines without a display
+
+    celerit_bench [--filter=text] [--json=results.json] [--font=path/to/font.ttf]
+
+drawing goes through the software renderer of a headless screen, so draw timings are CPU rasterization
+and comparable between runs on the same machine rather than with a GPU renderer
+everything random is seeded so each run does the same work
+*/
+#include "../Celerit/Celerit.hpp"
+#include "bench.hpp"
+
+#include <fstream>
+#include <random>
+
+using bench::keep;
+
+static std::mt19937 rng(1234);
+
+static int random_int(int lo, int hi) {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+static double random_double(double lo, double hi) {
+    return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+static rect random_rect(int world, int max_size) {
+    return rect{{random_int(0, world), random_int(0, world), random_int(1, max_size), random_int(1, max_size)}};
+}
+
+static void geometry_benchmarks(bench::suite& s) {
+    //1024 of everything, indexed with i & 1023 so the working set stays in cache and the loop has no branches
+    std::vector<rect> rects_a, rects_b;
+    std::vector<quad> quads;
+    std::vector<dvec2> points, vecs;
+    for (int i = 0; i < 1024; i++) {
+        rects_a.push_back(random_rect(1000, 100));
+        rects_b.push_back(random_rect(1000, 100));
+        dvec2 c = {random_double(0, 1000), random_double(0, 1000)};
+        double r = random_double(10, 100);
+        double a = random_double(0, 360);
+        quad q;
+        for (int k = 0; k < 4; k++) q[k] = dvec2{c.x + r, c.y}.get_rotated(a + 90.0*k, c);
+        quads.push_back(q);
+        points.push_back({c.x + random_double(-120, 120), c.y + random_double(-120, 120)});
+        vecs.push_back({random_double(-100, 100), random_double(-100, 100)});
+    }
+
+    s.run("geometry/collide_rect", [&](int64_t n) {
+        int hits = 0;
+        for (int64_t i = 0; i < n; i++) hits += collide_rect(rects_a[i & 1023], rects_b[(i * 7) & 1023]);
+        keep(hits);
+    });
+
+    std::vector<dline> walls;
+    for (int i = 0; i < 64; i++) {
+        walls.push_back({{random_double(0, 1000), random_double(0, 1000)}, {random_double(0, 1000), random_double(0, 1000)}});
+    }
+    s.run("geometry/ray_cast 64 lines", [&](int64_t n) {
+        int hits = 0;
+        for (int64_t i = 0; i < n; i++) {
+            dvec2 p = points[i & 1023];
+            hits += ray_cast({p, {p.x + 2000, p.y + 1}}, walls);
+        }
+        keep(hits);
+    }, 64);
+
+    s.run("geometry/quad::is_in", [&](int64_t n) {
+        int hits = 0;
+        for (int64_t i = 0; i < n; i++) hits += quads[i & 1023].is_in(points[i & 1023]);
+        keep(hits);
+    });
+
+    s.run("geometry/quad::is_in_concave", [&](int64_t n) {
+        int hits = 0;
+        for (int64_t i = 0; i < n; i++) hits += quads[i & 1023].is_in_concave(points[i & 1023]);
+        keep(hits);
+    });
+
+    s.run("v2/normalize", [&](int64_t n) {
+        dvec2 sum = {0, 0};
+        for (int64_t i = 0; i < n; i++) sum += vecs[i & 1023].normalize();
+        keep(sum);
+    });
+
+    s.run("v2/get_rotated", [&](int64_t n) {
+        dvec2 sum = {0, 0};
+        for (int64_t i = 0; i < n; i++) sum += vecs[i & 1023].get_rotated(static_cast<double>(i & 359), points[i & 1023]);
+        keep(sum);
+    });
+
+    s.run("v2/add_sub_distance", [&](int64_t n) {
+        double sum = 0;
+        for (int64_t i = 0; i < n; i++) sum += (vecs[i & 1023] + vecs[(i + 1) & 1023] - points[i & 1023]).get_distance2();
+        keep(sum);
+    });
+}
+
+static void level_benchmarks(bench::suite& s, renderer& r) {
+    for (int count: {1000, 10000, 100000}) {
+        string name = "level/is_colliding " + std::to_string(count / 1000) + "k colliders";
+        if (!s.enabled(name)) continue;
+
+        //the world grows with the collider count so the density, and the number of rects near a probe, stays the same
+        int world = static_cast<int>(std::sqrt(static_cast<double>(count)) * 64);
+        std::vector<rect> colliders;
+        colliders.reserve(count);
+        for (int i = 0; i < count; i++) colliders.push_back(random_rect(world, 48));
+
+        level lvl(r);
+        for (rect& c: colliders) lvl.add_collision(&c);
+
+        std::vector<rect> probes;
+        for (int i = 0; i < 1024; i++) probes.push_back(random_rect(world, 32));
+
+        s.run(name, [&](int64_t n) {
+            int hits = 0;
+            for (int64_t i = 0; i < n; i++) hits += lvl.is_colliding(probes[i & 1023]);
+            keep(hits);
+        });
+    }
+}
+
+static void particle_benchmarks(bench::suite& s, renderer& r) {
+    const int count = 10000;
+
+    if (s.enabled("particles/update 10k")) {
+        ParticleEmitter emitter(r, {640, 360}, count, 4, 4, Particle::SPREAD);
+        emitter.spawn_particles(count);
+        s.run("particles/update 10k", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) {
+                emitter.update(1.0 / 60.0);
+                //particles live for 10 seconds, top them back up so the count stays the same
+                if (emitter.get_alive_particles() < count) emitter.spawn_particles(count - emitter.get_alive_particles());
+            }
+            keep(emitter);
+        }, count);
+    }
+
+    //a store big enough to split across the workers, serially and through a job_system
+    if (s.enabled("particles/integrate 200k serial") || s.enabled("particles/integrate 200k parallel")) {
+        const int big = 200000;
+        job_system jobs;
+        Particle::store store;
+        store.resize(big);
+        auto refill = [&] {
+            while (store.alive_count() < big) store.spawn({{0, 0}, {1, 1}, {0, 0.1}}, 1000.0, false);
+        };
+        refill();
+        s.run("particles/integrate 200k serial", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) store.integrate(1.0 / 60.0, 1.0f / 60.0f);
+            refill();
+        }, big);
+        s.run("particles/integrate 200k parallel (" + std::to_string(jobs.get_worker_count()) + " workers)", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) store.integrate(jobs, 1.0 / 60.0, 1.0f / 60.0f);
+            refill();
+        }, big);
+    }
+
+    if (s.enabled("particles/spawn_particles 1k")) {
+        ParticleEmitter emitter(r, {640, 360}, 1000, 4, 4, Particle::SPREAD);
+        s.run("particles/spawn_particles 1k", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) {
+                emitter.spawn_particles(1000);
+                //a step longer than their life span clears them out for the next iteration
+                emitter.update(11.0);
+            }
+            keep(emitter);
+        }, 1000);
+    }
+
+    if (s.enabled("particles/draw 10k")) {
+        ParticleEmitter emitter(r, {640, 360}, count, 4, 4, Particle::SPREAD);
+        emitter.spawn_particles(count);
+        for (int i = 0; i < 60; i++) emitter.update(1.0 / 60.0);
+        r.set_batching(true);
+        s.run("particles/draw 10k", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) {
+                emitter.draw();
+                r.flush_batch();
+            }
+        }, count);
+        r.set_batching(false);
+    }
+}
+
+static void renderer_benchmarks(bench::suite& s, renderer& r) {
+    const int count = 10000;
+    texture sprite(r, 16, 16);
+    r.set_render_target(sprite);
+    r.fill({200, 80, 40, 255});
+    r.reset_target();
+
+    std::vector<ivec2> positions;
+    for (int i = 0; i < count; i++) positions.push_back({random_int(-16, 1280), random_int(-16, 720)});
+
+    r.set_batching(true);
+    s.run("renderer/batched blits 10k", [&](int64_t n) {
+        for (int64_t i = 0; i < n; i++) {
+            for (ivec2& p: positions) r.blit_texture(sprite, p.x, p.y);
+            r.flush_batch();
+        }
+    }, count);
+    r.set_batching(false);
+
+    s.run("renderer/immediate blits 10k", [&](int64_t n) {
+        for (int64_t i = 0; i < n; i++) {
+            for (ivec2& p: positions) r.blit_texture(sprite, p.x, p.y);
+        }
+    }, count);
+
+    sprite.destroy_texture();
+}
+
+static void text_benchmarks(bench::suite& s, renderer& r) {
+    string font_path = s.get_option("font", "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+    if (!std::ifstream(font_path)) {
+        s.skip("text/text_stream 20 lines", "no font at " + font_path + ", pass one with --font=");
+        return;
+    }
+
+    font f(font_path, 16);
+    text_stream ts(r, {10, 10}, f, {255, 255, 255, 255});
+    r.set_batching(true);
+    s.run("text/text_stream 20 lines", [&](int64_t n) {
+        for (int64_t i = 0; i < n; i++) {
+            //half the lines change every frame, the other half are retained
+            for (int line = 0; line < 20; line++) {
+                ts << "line " << line << ": ";
+                if (line % 2 == 0) ts << static_cast<int>(i) << "\n";
+                else ts << "static text\n";
+            }
+            ts.flush();
+            r.flush_batch();
+        }
+    }, 20);
+    r.set_batching(false);
+}
+
+//a sprite that moves itself, the sprite_group side of the ecs comparison
+class moving_sprite : public sprite {
+    public:
+    dvec2 vel;
+
+    moving_sprite(renderer& r, dvec2 pos, dvec2 v) : sprite(r, pos) {
+        vel = v;
+    }
+
+    void fixed_update(seconds_t dt) override {
+        move({vel.x * static_cast<double>(dt), vel.y * static_cast<double>(dt)});
+    }
+};
+
+static void ecs_benchmarks(bench::suite& s, renderer& r) {
+    //the same 100k moving objects as sprite subclasses in a sprite_group and as components in an ecs::world
+    const int count = 100000;
+    if (s.enabled("ecs/sprite_group::update 100k")) {
+        sprite_group group;
+        for (int i = 0; i < count; i++) {
+            group.create_sprite(moving_sprite(r, {random_double(0, 1280), random_double(0, 720)}, {random_double(-50, 50), random_double(-50, 50)}));
+        }
+        s.run("ecs/sprite_group::update 100k", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) group.update(1.0 / 60.0);
+        }, count);
+    }
+
+    if (s.enabled("ecs/integrate_motion 100k serial") || s.enabled("ecs/integrate_motion 100k parallel")) {
+        job_system jobs;
+        ecs::world w;
+        for (int i = 0; i < count; i++) {
+            ecs::entity e = w.create();
+            w.add<ecs::transform>(e, dvec2{random_double(0, 1280), random_double(0, 720)});
+            w.add<ecs::velocity>(e, dvec2{random_double(-50, 50), random_double(-50, 50)});
+        }
+        s.run("ecs/integrate_motion 100k serial", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) ecs::integrate_motion(w, 1.0 / 60.0);
+        }, count);
+        s.run("ecs/integrate_motion 100k parallel (" + std::to_string(jobs.get_worker_count()) + " workers)", [&](int64_t n) {
+            for (int64_t i = 0; i < n; i++) ecs::integrate_motion(w, 1.0 / 60.0, jobs);
+        }, count);
+    }
+}
+
+static void ui_benchmarks(bench::suite& s, renderer& r) {
+    const int bars = 200;
+    texture icon(r, 24, 24);
+    r.set_render_target(icon);
+    r.fill({40, 120, 220, 255});
+    r.reset_target();
+
+    //the same layout drawn element by element and through a retained draw list
+    canvas immediate({0, 0});
+    canvas retained(r, {0, 0});
+    for (canvas* c: {&immediate, &retained}) {
+        for (int i = 0; i < bars; i++) {
+            dvec2 pos = {static_cast<double>((i % 10) * 120 + 10), static_cast<double>((i / 10) * 34 + 10)};
+            progress_bar* bar = c->create_UI_element(progress_bar(r, color{40, 40, 40, 255}, color{60, 200, 90, 255}, pos, 80, 12));
+            bar->set_percent(static_cast<float>(i % 100) / 100.0f);
+            c->create_UI_element(image(r, icon, {pos.x + 86, pos.y}));
+        }
+    }
+
+    s.run("ui/canvas::draw immediate 400 elements", [&](int64_t n) {
+        for (int64_t i = 0; i < n; i++) {
+            immediate.draw();
+            r.flush_batch();
+        }
+    }, bars * 2);
+
+    s.run("ui/canvas::draw retained 400 elements", [&](int64_t n) {
+        for (int64_t i = 0; i < n; i++) {
+            retained.draw();
+            r.flush_batch();
+        }
+    }, bars * 2);
+
+    icon.destroy_texture();
+}
+
+int main(int argc, char** argv) {
+    bench::suite s(argc, argv);
+
+    CELERIT_INIT_HEADLESS();
+    screen scr(1280, 720, HEADLESS);
+    renderer r(scr);
+
+    geometry_benchmarks(s);
+    level_benchmarks(s, r);
+    particle_benchmarks(s, r);
+    renderer_benchmarks(s, r);
+    text_benchmarks(s, r);
+    ecs_benchmarks(s, r);
+    ui_benchmarks(s, r);
+
+    int ret = s.finish();
+    CELERIT_QUIT();
+    return ret;
+}
@@ -0,0 +1,68 @@
+/*
+compares how many particles per millisecond can be updated with the old array-of-structs Particle::Instance layout
+and with the structure-of-arrays Particle::store and its SIMD kernel
+*/
+#include "../Celerit/Particle.hpp"
+
+#include <iostream>
+#include <vector>
+
+static double particles_per_ms(int particles, int iterations, milliseconds_t elapsed) {
+    //a run too short for the clock to see has no rate, 0 rather than infinity
+    if (elapsed <= 0) return 0.0;
+    return (static_cast<double>(particles) * iterations) / static_cast<double>(elapsed);
+}
+
+int main(int argc, char** argv) {
+    int particles = argc > 1 ? atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+    if (particles < 1 || iterations < 1) {
+        std::cerr << "usage: " << argv[0] << " [particles] [iterations], both at least 1\n";
+        return 1;
+    }
+
+    //the old layout, every update reads the clock twice per particle
+    std::vector<Instance> instances;
+    instances.reserve(particles);
+    for (int i = 0; i < particles; i++) {
+        instances.push_back(Instance({0, 0}, {1, 1}, {0, 0.1}, 1000.0));
+    }
+
+    milliseconds_t start = getUTCMilliTime();
+    for (int it = 0; it < iterations; it++) {
+        for (Instance& inst: instances) {
+            inst.update();
+        }
+    }
+    milliseconds_t aos_time = getUTCMilliTime() - start;
+
+    //the new layout, one clock read per update
+    Particle::store store;
+    store.resize(particles);
+    for (int i = 0; i < particles; i++) {
+        store.spawn({{0, 0}, {1, 1}, {0, 0.1}}, 1000.0, false);
+    }
+
+    seconds_t last = getUTCTime();
+    start = getUTCMilliTime();
+    for (int it = 0; it < iterations; it++) {
+        seconds_t now = getUTCTime();
+        store.integrate(now - last);
+        last = now;
+    }
+    milliseconds_t soa_time = getUTCMilliTime() - start;
+
+    //keep the results alive so the loops arent optimized away
+    volatile float sink = store.pos_x[particles / 2] + static_cast<float>(instances[particles / 2].position.x);
+    (void)sink;
+
+    std::cout << "particles: " << particles << ", iterations: " << iterations << "\n";
+    std::cout << "Instance (AoS):        " << particles_per_ms(particles, iterations, aos_time) << " particles/ms\n";
+    std::cout << "Particle::store (SoA): " << particles_per_ms(particles, iterations, soa_time) << " particles/ms\n";
+    if (aos_time > 0 && soa_time > 0) {
+        std::cout << "speedup: " << static_cast<double>(aos_time / soa_time) << "x\n";
+    } else {
+        std::cout << "speedup: runs too short to time, use more particles or iterations\n";
+    }
+    return 0;
+}
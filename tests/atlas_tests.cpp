@@ -0,0 +1,123 @@
+/*
+checks the texture_atlas skyline packer keeps every image on its page without overlapping another, and that the pixels end up where the region says
+runs on a headless screen, so it doesnt need a display
+*/
+#include "../Celerit/Celerit.hpp"
+#include "check.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+static renderer* rend;
+
+static SDL_Surface* solid_surface(int w, int h, Uint32 argb) {
+    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_FillRect(surf, nullptr, argb);
+    return surf;
+}
+
+static Uint32 color_for(int i) {
+    //a different opaque color per image, so a misplaced image shows up as the wrong color
+    return 0xFF000000u | (static_cast<Uint32>(i) * 2654435761u >> 8);
+}
+
+static rect padded(rect r, int padding) {
+    return rect{{r.x, r.y, r.w + padding, r.h + padding}};
+}
+
+TEST_CASE("texture_atlas/packed images stay on their page and never overlap") {
+    const int page_size = 256;
+    const int padding = 1;
+    texture_atlas atlas(*rend, page_size, padding);
+
+    std::mt19937 rng(10);
+    std::uniform_int_distribution<int> size(1, 48);
+    std::vector<atlas_region> regions;
+    for (int i = 0; i < 300; i++) {
+        SDL_Surface* surf = solid_surface(size(rng), size(rng), color_for(i));
+        atlas_region region = atlas.add("image" + std::to_string(i), surf);
+        CHECK(region.get_source().w == surf->w && region.get_source().h == surf->h);
+        SDL_FreeSurface(surf);
+        regions.push_back(region);
+    }
+    CHECK(atlas.get_page_count() > 1);
+
+    bool in_bounds = true;
+    bool overlapping = false;
+    for (size_t i = 0; i < regions.size(); i++) {
+        rect r = regions[i].get_source();
+        in_bounds = in_bounds && r.x >= 0 && r.y >= 0 && r.x + r.w + padding <= page_size && r.y + r.h + padding <= page_size;
+        in_bounds = in_bounds && regions[i].page_index >= 0 && regions[i].page_index < atlas.get_page_count();
+
+        //the padding is part of what was packed, so even the padded rects cant overlap
+        for (size_t j = i + 1; j < regions.size(); j++) {
+            if (regions[i].page_index != regions[j].page_index) continue;
+            overlapping = overlapping || !rect_empty(intersect_rect(padded(r, padding), padded(regions[j].get_source(), padding)));
+        }
+    }
+    CHECK(in_bounds);
+    CHECK(!overlapping);
+
+    //every page but the last was full enough to spill, so they should be well packed
+    for (int p = 0; p + 1 < atlas.get_page_count(); p++) {
+        CHECK(atlas.get_page_occupancy(p) > 0.6);
+        CHECK(atlas.get_page_occupancy(p) <= 1.0);
+    }
+}
+
+TEST_CASE("texture_atlas/names, oversized images and pixels") {
+    texture_atlas atlas(*rend, 128, 1);
+
+    SDL_Surface* small = solid_surface(10, 12, color_for(1));
+    atlas_region first = atlas.add("small", small);
+    //the same name gives back the same region without packing it again
+    atlas_region again = atlas.add("small", small);
+    CHECK(again.page_index == first.page_index && again.get_source().x == first.get_source().x && again.get_source().y == first.get_source().y);
+    CHECK(atlas.contains("small"));
+    CHECK(!atlas.contains("missing"));
+    CHECK(atlas.get("missing").is_null());
+    CHECK(atlas.get("small").get_source().w == 10);
+    SDL_FreeSurface(small);
+
+    //an image bigger than a page gets a page of its own
+    SDL_Surface* wide = solid_surface(200, 20, color_for(2));
+    atlas_region big = atlas.add("wide", wide);
+    SDL_FreeSurface(wide);
+    CHECK(big.page_index != first.page_index);
+    CHECK(big.get_texture().get_pixel_size().x >= 201);
+
+    SDL_Surface* other = solid_surface(30, 7, color_for(3));
+    atlas_region next = atlas.add("other", other);
+    SDL_FreeSurface(other);
+    CHECK(next.page_index == first.page_index);
+
+    //drawing each region shows only its own color
+    atlas_region drawn[] = {first, big, next};
+    Uint32 colors[] = {color_for(1), color_for(2), color_for(3)};
+    for (int i = 0; i < 3; i++) {
+        rend->fill(BLACK);
+        rect src = drawn[i].get_source();
+        rend->blit_texture(drawn[i].get_texture(), src, rect{{0, 0, src.w, src.h}});
+
+        std::vector<uint32_t> pixels(static_cast<size_t>(src.w) * src.h);
+        if (!CHECK(rend->read_pixels(rect{{0, 0, src.w, src.h}}, pixels.data(), src.w * 4))) continue;
+        bool all_match = true;
+        for (uint32_t p: pixels) all_match = all_match && p == colors[i];
+        CHECK(all_match);
+    }
+}
+
+int main(int argc, char** argv) {
+    CELERIT_INIT_HEADLESS();
+    int result;
+    {
+        //the renderer has to be gone before SDL is shut down
+        screen s(320, 240, HEADLESS);
+        renderer r(s);
+        rend = &r;
+        result = check::run(argc, argv);
+    }
+    CELERIT_QUIT();
+    return result;
+}
@@ -0,0 +1,85 @@
+#ifndef CELERIT_CHECK
+#define CELERIT_CHECK
+
+/*
+a small test harness, so the tests dont need anything but the standard library
+
+    TEST_CASE("spatial_grid/query_rect matches a linear scan") {
+        ...
+        CHECK(found == expected);
+    }
+
+    int main(int argc, char** argv) {
+        return check::run(argc, argv);
+    }
+
+a failed CHECK is reported with its file and line and the case carries on, so one run shows every failure
+pass a name (or part of one) on the command line to only run the cases that match
+*/
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace check {
+    struct test_case {
+        const char* name;
+        void (*func)();
+    };
+
+    inline std::vector<test_case>& get_cases() {
+        static std::vector<test_case> cases;
+        return cases;
+    }
+
+    inline int& get_failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    struct registrar {
+        registrar(const char* name, void (*func)()) {
+            get_cases().push_back({name, func});
+        }
+    };
+
+    inline bool expect(bool ok, const char* expr, const char* file, int line) {
+        if (!ok) {
+            std::cerr << file << ":" << line << ": CHECK(" << expr << ") failed\n";
+            get_failures()++;
+        }
+        return ok;
+    }
+
+    inline int run(int argc, char** argv) {
+        //runs every case (or the ones matching argv[1]), returns the exit code for ctest
+        const char* filter = argc > 1 ? argv[1] : "";
+        int ran = 0;
+        int failed_cases = 0;
+        for (test_case& c: get_cases()) {
+            if (strstr(c.name, filter) == nullptr) continue;
+            int before = get_failures();
+            c.func();
+            ran++;
+            bool passed = get_failures() == before;
+            if (!passed) failed_cases++;
+            std::cout << (passed ? "ok      " : "FAILED  ") << c.name << "\n";
+        }
+        std::cout << ran - failed_cases << "/" << ran << " cases passed\n";
+        return failed_cases == 0 && ran > 0 ? 0 : 1;
+    }
+}
+
+#define CHECK_JOIN_(a, b) a##b
+#define CHECK_JOIN(a, b) CHECK_JOIN_(a, b)
+
+//defines a test case, the body follows like a function body
+#define TEST_CASE(name) \
+    static void CHECK_JOIN(check_case_, __LINE__)(); \
+    static check::registrar CHECK_JOIN(check_registrar_, __LINE__)(name, CHECK_JOIN(check_case_, __LINE__)); \
+    static void CHECK_JOIN(check_case_, __LINE__)()
+
+//records a failure if expr is false, evaluates to whether it passed so a case can bail out with if (!CHECK(...)) return;
+#define CHECK(expr) check::expect(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,216 @@
+/*
+checks ecs::world against a plain map of what every entity should have, under random creates, destroys, adds and removes
+*/
+#include "../Celerit/ecs.hpp"
+#include "check.hpp"
+
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+struct health {
+    int hp;
+};
+
+struct team {
+    int id;
+};
+
+//what the world should hold, entity to component value, -1 for no component
+struct model_entity {
+    int hp = -1;
+    int team_id = -1;
+};
+
+static bool world_matches(ecs::world& w, const std::map<ecs::entity, model_entity>& model, const std::vector<ecs::entity>& dead) {
+    bool ok = w.get_entity_count() == model.size();
+    size_t with_health = 0;
+    size_t with_team = 0;
+
+    for (const std::pair<const ecs::entity, model_entity>& m: model) {
+        ecs::entity e = m.first;
+        ok = ok && w.is_alive(e);
+        ok = ok && w.has<health>(e) == (m.second.hp >= 0) && w.has<team>(e) == (m.second.team_id >= 0);
+        if (m.second.hp >= 0) {
+            with_health++;
+            ok = ok && w.get<health>(e).hp == m.second.hp && w.try_get<health>(e) == &w.get<health>(e);
+        } else {
+            ok = ok && w.try_get<health>(e) == nullptr;
+        }
+        if (m.second.team_id >= 0) {
+            with_team++;
+            ok = ok && w.get<team>(e).id == m.second.team_id;
+        }
+    }
+
+    //a destroyed entitys handle stays dead even after its index is reused
+    for (ecs::entity e: dead) {
+        ok = ok && !w.is_alive(e) && !w.has<health>(e) && !w.has<team>(e);
+    }
+
+    //the packed arrays line up, component i belongs to entity i
+    ecs::component_pool<health>& healths = w.pool<health>();
+    ok = ok && healths.size() == with_health && w.pool<team>().size() == with_team;
+    for (size_t i = 0; i < healths.size(); i++) {
+        std::map<ecs::entity, model_entity>::const_iterator found = model.find(healths.entities()[i]);
+        ok = ok && found != model.end() && healths.components()[i].hp == found->second.hp;
+    }
+    return ok;
+}
+
+TEST_CASE("ecs::world/components match a reference map under random changes") {
+    std::mt19937 rng(8);
+    std::uniform_int_distribution<int> op(0, 9);
+    std::uniform_int_distribution<int> value(0, 1000);
+
+    ecs::world w;
+    std::map<ecs::entity, model_entity> model;
+    std::vector<ecs::entity> alive;
+    std::vector<ecs::entity> dead;
+
+    bool matches = true;
+    for (int step = 0; step < 20000 && matches; step++) {
+        int o = op(rng);
+        if (alive.empty() || o <= 2) {
+            ecs::entity e = w.create();
+            matches = model.count(e) == 0;
+            model[e] = {};
+            alive.push_back(e);
+            continue;
+        }
+
+        size_t pick = std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng);
+        ecs::entity e = alive[pick];
+        switch (o) {
+            case 3: {
+                w.destroy(e);
+                model.erase(e);
+                alive[pick] = alive.back();
+                alive.pop_back();
+                dead.push_back(e);
+                break;
+            }
+            case 4:
+            case 5: {
+                int hp = value(rng);
+                w.add<health>(e, hp);
+                model[e].hp = hp;
+                break;
+            }
+            case 6:
+                w.remove<health>(e);
+                model[e].hp = -1;
+                break;
+            case 7:
+            case 8: {
+                int id = value(rng);
+                w.add<team>(e, id);
+                model[e].team_id = id;
+                break;
+            }
+            default:
+                w.remove<team>(e);
+                model[e].team_id = -1;
+                break;
+        }
+
+        if (step % 500 == 0) matches = world_matches(w, model, dead);
+    }
+    CHECK(matches);
+    CHECK(world_matches(w, model, dead));
+}
+
+TEST_CASE("ecs::world/each visits exactly the entities with every component") {
+    ecs::world w;
+    std::set<ecs::entity> both;
+    for (int i = 0; i < 500; i++) {
+        ecs::entity e = w.create();
+        if (i % 2 == 0) w.add<health>(e, i);
+        if (i % 3 == 0) w.add<team>(e, i);
+        if (i % 6 == 0) both.insert(e);
+    }
+
+    std::set<ecs::entity> visited;
+    bool values_match = true;
+    w.each<team, health>([&](ecs::entity e, team& t, health& h) {
+        visited.insert(e);
+        values_match = values_match && t.id == h.hp;
+    });
+    CHECK(visited == both);
+    CHECK(values_match);
+}
+
+TEST_CASE("ecs::world/destroyed ids are reused with a new version") {
+    ecs::world w;
+    ecs::entity first = w.create();
+    w.add<health>(first, 5);
+    w.destroy(first);
+    CHECK(!w.is_alive(first));
+    CHECK(w.get_entity_count() == 0);
+
+    //destroying twice does nothing
+    w.destroy(first);
+    CHECK(w.get_entity_count() == 0);
+
+    ecs::entity second = w.create();
+    CHECK(ecs::entity_index(second) == ecs::entity_index(first));
+    CHECK(ecs::entity_version(second) != ecs::entity_version(first));
+    CHECK(w.is_alive(second));
+    CHECK(!w.has<health>(second));
+    CHECK(!w.is_alive(ecs::NULL_ENTITY));
+}
+
+TEST_CASE("ecs::world/the last index never comes back as NULL_ENTITY") {
+    ecs::world w;
+    ecs::entity last = ecs::NULL_ENTITY;
+    for (uint32_t i = 0; i <= ecs::INDEX_MASK; i++) last = w.create();
+    CHECK(ecs::entity_index(last) == ecs::INDEX_MASK);
+
+    //every version the index can have, and then some so the version wraps around
+    bool never_null = true;
+    for (int i = 0; i < 5000; i++) {
+        w.destroy(last);
+        last = w.create();
+        never_null = never_null && last != ecs::NULL_ENTITY && w.is_alive(last);
+    }
+    CHECK(never_null);
+    CHECK(ecs::entity_index(last) == ecs::INDEX_MASK);
+    CHECK(w.get_entity_count() == ecs::INDEX_MASK + 1);
+}
+
+TEST_CASE("ecs::integrate_motion/across jobs matches one thread") {
+    ecs::world serial;
+    ecs::world parallel;
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> v(-50, 50);
+    for (int i = 0; i < 20000; i++) {
+        dvec2 pos = {v(rng), v(rng)};
+        dvec2 vel = {v(rng), v(rng)};
+        dvec2 acc = {v(rng), v(rng)};
+        for (ecs::world* w: {&serial, &parallel}) {
+            ecs::entity e = w->create();
+            //every third entity has no transform, so integrate_motion has to skip it
+            if (i % 3 != 0) w->add<ecs::transform>(e, pos);
+            w->add<ecs::velocity>(e, vel, acc);
+        }
+    }
+
+    job_system jobs(3);
+    for (int frame = 0; frame < 10; frame++) {
+        ecs::integrate_motion(serial, 1.0 / 60.0);
+        ecs::integrate_motion(parallel, 1.0 / 60.0, jobs, 512);
+    }
+
+    bool same = serial.pool<ecs::transform>().size() == parallel.pool<ecs::transform>().size();
+    std::vector<ecs::transform>& a = serial.pool<ecs::transform>().get_components();
+    std::vector<ecs::transform>& b = parallel.pool<ecs::transform>().get_components();
+    for (size_t i = 0; i < a.size() && same; i++) {
+        same = a[i].position.x == b[i].position.x && a[i].position.y == b[i].position.y;
+    }
+    CHECK(same);
+}
+
+int main(int argc, char** argv) {
+    return check::run(argc, argv);
+}
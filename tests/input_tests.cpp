@@ -0,0 +1,326 @@
+/*
+checks key binds run in the order they were made, and that a recorded input session replays into the same state
+the replay test pushes events through the real SDL event queue, so it only needs SDL_INIT_EVENTS (no display)
+*/
+#include "../Celerit/input.hpp"
+#include "check.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("key_bind_table/binds run in the order they were added, per scancode") {
+    key_bind_table binds;
+    std::string order;
+    binds.add(SDL_SCANCODE_B, [&order] { order += "b1 "; });
+    binds.add(SDL_SCANCODE_A, [&order] { order += "a1 "; });
+    binds.add(SDL_SCANCODE_SPACE, [&order] { order += "s1 "; });
+    binds.add(SDL_SCANCODE_B, [&order] { order += "b2 "; });
+    binds.add(SDL_SCANCODE_A, [&order] { order += "a2 "; });
+    binds.add(SDL_SCANCODE_B, [&order] { order += "b3 "; });
+
+    binds.dispatch(SDL_SCANCODE_B);
+    CHECK(order == "b1 b2 b3 ");
+
+    order.clear();
+    binds.dispatch(SDL_SCANCODE_A);
+    CHECK(order == "a1 a2 ");
+
+    order.clear();
+    binds.dispatch(SDL_SCANCODE_SPACE);
+    CHECK(order == "s1 ");
+
+    //keys with no binds and scancodes out of range do nothing
+    order.clear();
+    binds.dispatch(SDL_SCANCODE_C);
+    binds.dispatch(static_cast<SDL_Scancode>(-1));
+    binds.dispatch(SDL_NUM_SCANCODES);
+    CHECK(order.empty());
+
+    binds.clear();
+    binds.dispatch(SDL_SCANCODE_B);
+    CHECK(order.empty());
+
+    //binds added after a clear start from scratch
+    binds.add(SDL_SCANCODE_A, [&order] { order += "a3 "; });
+    binds.dispatch(SDL_SCANCODE_A);
+    CHECK(order == "a3 ");
+}
+
+static std::vector<SDL_Event> sample_events() {
+    //one event of every type the log knows about, with every recorded field set
+    std::vector<SDL_Event> events;
+    SDL_Event e;
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_KEYDOWN;
+    e.key.state = SDL_PRESSED;
+    e.key.keysym.scancode = SDL_SCANCODE_A;
+    e.key.keysym.sym = 'a';
+    e.key.keysym.mod = 0x0040;
+    e.key.repeat = 1;
+    events.push_back(e);
+
+    e.type = SDL_KEYUP;
+    e.key.state = SDL_RELEASED;
+    e.key.repeat = 0;
+    events.push_back(e);
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_MOUSEMOTION;
+    e.motion.state = SDL_BUTTON(SDL_BUTTON_LEFT);
+    e.motion.x = 120;
+    e.motion.y = -4;
+    e.motion.xrel = 7;
+    e.motion.yrel = -9;
+    events.push_back(e);
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_MOUSEBUTTONDOWN;
+    e.button.state = SDL_PRESSED;
+    e.button.button = SDL_BUTTON_LEFT;
+    e.button.clicks = 2;
+    e.button.x = 300;
+    e.button.y = 200;
+    events.push_back(e);
+
+    e.type = SDL_MOUSEBUTTONUP;
+    e.button.state = SDL_RELEASED;
+    events.push_back(e);
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_MOUSEWHEEL;
+    e.wheel.x = -1;
+    e.wheel.y = 3;
+    events.push_back(e);
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_TEXTINPUT;
+    strcpy(e.text.text, "hello");
+    events.push_back(e);
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_WINDOWEVENT;
+    e.window.event = SDL_WINDOWEVENT_RESIZED;
+    e.window.data1 = 640;
+    e.window.data2 = 480;
+    events.push_back(e);
+
+    memset(&e, 0, sizeof(e));
+    e.type = SDL_QUIT;
+    events.push_back(e);
+
+    for (size_t i = 0; i < events.size(); i++) events[i].key.timestamp = static_cast<Uint32>(1000 + i);
+    return events;
+}
+
+static bool same_event(const SDL_Event& a, const SDL_Event& b) {
+    //compares the fields the log keeps
+    if (a.type != b.type || a.key.timestamp != b.key.timestamp) return false;
+    switch (a.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            return a.key.state == b.key.state && a.key.keysym.scancode == b.key.keysym.scancode && a.key.keysym.sym == b.key.keysym.sym &&
+                   a.key.keysym.mod == b.key.keysym.mod && a.key.repeat == b.key.repeat;
+        case SDL_MOUSEMOTION:
+            return a.motion.state == b.motion.state && a.motion.x == b.motion.x && a.motion.y == b.motion.y &&
+                   a.motion.xrel == b.motion.xrel && a.motion.yrel == b.motion.yrel;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            return a.button.state == b.button.state && a.button.button == b.button.button && a.button.clicks == b.button.clicks &&
+                   a.button.x == b.button.x && a.button.y == b.button.y;
+        case SDL_MOUSEWHEEL:
+            return a.wheel.x == b.wheel.x && a.wheel.y == b.wheel.y;
+        case SDL_TEXTINPUT:
+            return strcmp(a.text.text, b.text.text) == 0;
+        case SDL_WINDOWEVENT:
+            return a.window.event == b.window.event && a.window.data1 == b.window.data1 && a.window.data2 == b.window.data2;
+        default:
+            return true;
+    }
+}
+
+TEST_CASE("input_log/every event type reads back the way it was written") {
+    std::vector<SDL_Event> events = sample_events();
+    std::stringstream log;
+    for (size_t i = 0; i < events.size(); i++) {
+        input_log::write_event(log, static_cast<uint32_t>(i * 3), events[i]);
+    }
+
+    //event types input doesnt use arent written at all
+    SDL_Event ignored;
+    memset(&ignored, 0, sizeof(ignored));
+    ignored.type = SDL_TEXTEDITING;
+    std::streampos before = log.tellp();
+    input_log::write_event(log, 99, ignored);
+    CHECK(log.tellp() == before);
+
+    for (size_t i = 0; i < events.size(); i++) {
+        uint32_t frame = 0;
+        input_log::kind k;
+        SDL_Event e;
+        if (!CHECK(input_log::read_event(log, frame, k, e))) return;
+        CHECK(frame == i * 3);
+        CHECK(same_event(e, events[i]));
+    }
+
+    uint32_t frame;
+    input_log::kind k;
+    SDL_Event e;
+    CHECK(!input_log::read_event(log, frame, k, e));
+}
+
+TEST_CASE("input_log/records are little endian whatever the host is") {
+    SDL_Event motion = sample_events()[2];
+    motion.motion.timestamp = 0x0A0B0C0D;
+    std::stringstream log;
+    input_log::write_event(log, 0x01020304, motion);
+
+    //frame, timestamp, kind, then state, x, y, xrel and yrel, negative numbers as their twos complement
+    const unsigned char expected[] = {
+        0x04, 0x03, 0x02, 0x01,
+        0x0D, 0x0C, 0x0B, 0x0A,
+        input_log::MOUSE_MOTION,
+        SDL_BUTTON(SDL_BUTTON_LEFT), 0x00, 0x00, 0x00,
+        120, 0x00, 0x00, 0x00,
+        0xFC, 0xFF, 0xFF, 0xFF,
+        7, 0x00, 0x00, 0x00,
+        0xF7, 0xFF, 0xFF, 0xFF,
+    };
+    std::string bytes = log.str();
+    CHECK(bytes == std::string(reinterpret_cast<const char*>(expected), sizeof(expected)));
+}
+
+TEST_CASE("input_log/a cut off record is rejected") {
+    SDL_Event motion = sample_events()[2];
+    std::stringstream full;
+    input_log::write_event(full, 5, motion);
+    std::string bytes = full.str();
+
+    //every prefix of the record is missing part of it
+    bool all_rejected = true;
+    for (size_t length = 0; length < bytes.size(); length++) {
+        std::stringstream cut(bytes.substr(0, length));
+        uint32_t frame;
+        input_log::kind k;
+        SDL_Event e;
+        all_rejected = all_rejected && !input_log::read_event(cut, frame, k, e);
+    }
+    CHECK(all_rejected);
+}
+
+struct frame_state {
+    //what a game would read from input after a pump
+    std::bitset<SDL_NUM_SCANCODES> keys;
+    bool pressed_a;
+    bool released_a;
+    std::string text;
+    ivec2 wheel;
+    ivec2 mouse_pos;
+    uint32_t mouse_mask;
+    bool quit;
+    ivec2 window_size;
+    int event_count;
+    int binds_run;
+
+    bool operator ==(const frame_state& other) const {
+        return keys == other.keys && pressed_a == other.pressed_a && released_a == other.released_a && text == other.text &&
+               wheel.x == other.wheel.x && wheel.y == other.wheel.y && mouse_pos.x == other.mouse_pos.x && mouse_pos.y == other.mouse_pos.y &&
+               mouse_mask == other.mouse_mask && quit == other.quit && window_size.x == other.window_size.x &&
+               window_size.y == other.window_size.y && event_count == other.event_count && binds_run == other.binds_run;
+    }
+};
+
+static frame_state read_state(input& in, int binds_run) {
+    return {in.get_scancode_state(), in.pressed_this_frame(SDL_SCANCODE_A), in.released_this_frame(SDL_SCANCODE_A), in.get_text(),
+            in.get_mouse_wheel(), in.get_mouse_pos(), in.get_mouse().mask, in.quit_requested(), in.get_window_size(),
+            in.get_event_count(), binds_run};
+}
+
+static void push(SDL_Event e) {
+    SDL_PushEvent(&e);
+}
+
+TEST_CASE("input/a recording replays into the same state frame by frame") {
+    std::vector<SDL_Event> events = sample_events();
+    const SDL_Event& key_down = events[0];
+    const SDL_Event& key_up = events[1];
+    const SDL_Event& motion = events[2];
+    const SDL_Event& button_down = events[3];
+    const SDL_Event& button_up = events[4];
+    const SDL_Event& wheel = events[5];
+    const SDL_Event& text = events[6];
+    const SDL_Event& resize = events[7];
+    const SDL_Event& quit = events[8];
+
+    //the same session of 6 frames, some of them empty, is pushed while recording
+    std::vector<std::vector<SDL_Event>> session = {
+        {key_down, motion, motion, text},
+        {},
+        {button_down, wheel, motion},
+        {key_up, button_up, resize},
+        {},
+        {quit},
+    };
+    std::string path = (std::filesystem::temp_directory_path() / "celerit_input_test.clrinput").string();
+
+    input recorder;
+    int recorder_binds = 0;
+    recorder.bind_scancode_down(SDL_SCANCODE_A, [&recorder_binds] { recorder_binds++; });
+    recorder.bind_scancode_up(SDL_SCANCODE_A, [&recorder_binds] { recorder_binds += 10; });
+    recorder.pump();
+
+    std::vector<frame_state> recorded;
+    recorder.start_recording(path);
+    CHECK(recorder.is_recording());
+    for (std::vector<SDL_Event>& frame: session) {
+        for (SDL_Event& e: frame) push(e);
+        recorder.pump();
+        recorded.push_back(read_state(recorder, recorder_binds));
+    }
+    recorder.stop_recording();
+    CHECK(!recorder.is_recording());
+    CHECK(recorded[0].keys.test(SDL_SCANCODE_A) && recorded[0].text == "hello");
+    CHECK(recorder_binds == 11);
+
+    //a different input, a few frames in, replaying the file while a stray key is pressed for real
+    input player;
+    int player_binds = 0;
+    player.bind_scancode_down(SDL_SCANCODE_A, [&player_binds] { player_binds++; });
+    player.bind_scancode_up(SDL_SCANCODE_A, [&player_binds] { player_binds += 10; });
+    for (int i = 0; i < 3; i++) player.pump();
+
+    player.start_replay(path);
+    CHECK(player.is_replaying());
+    std::vector<frame_state> replayed;
+    for (size_t i = 0; i < session.size(); i++) {
+        SDL_Event stray = key_down;
+        stray.key.keysym.scancode = SDL_SCANCODE_B;
+        push(stray);
+        player.pump();
+        replayed.push_back(read_state(player, player_binds));
+    }
+    CHECK(!player.is_replaying());
+    CHECK(replayed.size() == recorded.size());
+    for (size_t i = 0; i < recorded.size() && i < replayed.size(); i++) {
+        CHECK(replayed[i] == recorded[i]);
+    }
+
+    //once the replay is over real events are used again
+    push(key_down);
+    player.pump();
+    CHECK(player.is_down(SDL_SCANCODE_A));
+
+    std::filesystem::remove(path);
+}
+
+int main(int argc, char** argv) {
+    if (SDL_Init(SDL_INIT_EVENTS) != 0) {
+        std::cerr << "could not initialize SDL events: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    int result = check::run(argc, argv);
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,258 @@
+/*
+checks the work stealing deque and job_system hand out every job exactly once,
+and that Particle::store keeps its alive particles packed whether it is updated on one thread or many
+*/
+#include "../Celerit/job_system.hpp"
+#include "../Celerit/Particle.hpp"
+#include "check.hpp"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST_CASE("work_stealing_deque/owner pops newest first, thieves steal oldest first") {
+    work_stealing_deque deque;
+    std::vector<job> jobs(4);
+    for (job& j: jobs) CHECK(deque.push(&j));
+
+    CHECK(deque.steal() == &jobs[0]);
+    CHECK(deque.pop() == &jobs[3]);
+    CHECK(deque.steal() == &jobs[1]);
+    CHECK(deque.pop() == &jobs[2]);
+    CHECK(deque.pop() == nullptr);
+    CHECK(deque.steal() == nullptr);
+}
+
+TEST_CASE("work_stealing_deque/push fails when full") {
+    work_stealing_deque deque;
+    std::vector<job> jobs(4097);
+    int pushed = 0;
+    for (job& j: jobs) pushed += deque.push(&j) ? 1 : 0;
+    CHECK(pushed == 4096);
+
+    //taking one makes room for one more
+    CHECK(deque.steal() == &jobs[0]);
+    CHECK(deque.push(&jobs[4096]));
+}
+
+TEST_CASE("work_stealing_deque/every job is taken exactly once with thieves racing the owner") {
+    const int rounds = 50;
+    const int per_round = 4000;
+    const int thieves = 3;
+
+    std::vector<job> jobs(per_round);
+    std::vector<std::atomic<int>> taken(per_round);
+    work_stealing_deque deque;
+    bool exactly_once = true;
+
+    for (int round = 0; round < rounds; round++) {
+        for (std::atomic<int>& t: taken) t.store(0);
+        std::atomic<int> total{0};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thieves; t++) {
+            threads.emplace_back([&] {
+                while (total.load() < per_round) {
+                    job* j = deque.steal();
+                    if (j == nullptr) continue;
+                    taken[j - jobs.data()].fetch_add(1);
+                    total.fetch_add(1);
+                }
+            });
+        }
+
+        //the owner pushes and pops at the same time as the thieves steal, so the last job is often raced for
+        for (int i = 0; i < per_round; i++) {
+            deque.push(&jobs[i]);
+            if (i % 3 == 0) {
+                job* j = deque.pop();
+                if (j != nullptr) {
+                    taken[j - jobs.data()].fetch_add(1);
+                    total.fetch_add(1);
+                }
+            }
+        }
+        while (total.load() < per_round) {
+            job* j = deque.pop();
+            if (j == nullptr) continue;
+            taken[j - jobs.data()].fetch_add(1);
+            total.fetch_add(1);
+        }
+
+        for (std::thread& t: threads) t.join();
+        for (std::atomic<int>& t: taken) exactly_once = exactly_once && t.load() == 1;
+        exactly_once = exactly_once && total.load() == per_round;
+    }
+    CHECK(exactly_once);
+}
+
+TEST_CASE("job_system/parallel_for covers every index exactly once") {
+    job_system jobs(3);
+    const int sizes[] = {0, 1, 7, 100, 4096, 10001};
+    const int chunk_sizes[] = {0, 1, 3, 64, 5000, 20000};
+
+    for (int size: sizes) {
+        for (int chunk: chunk_sizes) {
+            std::vector<std::atomic<int>> hits(size);
+            std::atomic<bool> ranges_ok{true};
+            jobs.parallel_for(0, size, [&](int first, int last) {
+                if (first < 0 || last > size || first >= last) ranges_ok.store(false);
+                for (int i = first; i < last; i++) hits[i].fetch_add(1);
+            }, chunk);
+
+            bool once = true;
+            for (std::atomic<int>& h: hits) once = once && h.load() == 1;
+            CHECK(ranges_ok.load());
+            CHECK(once);
+        }
+    }
+}
+
+TEST_CASE("job_system/parallel_for with an offset range and nested in a job") {
+    job_system jobs(2);
+    std::vector<std::atomic<int>> hits(1000);
+    job_counter done;
+
+    //a parallel_for inside a job runs on a worker, which pushes to its own deque instead of the shared queue
+    for (int outer = 0; outer < 4; outer++) {
+        jobs.submit([&jobs, &hits, outer] {
+            jobs.parallel_for(outer * 250, (outer + 1) * 250, [&hits](int first, int last) {
+                for (int i = first; i < last; i++) hits[i].fetch_add(1);
+            }, 16);
+        }, &done);
+    }
+    jobs.wait(done);
+
+    bool once = true;
+    for (std::atomic<int>& h: hits) once = once && h.load() == 1;
+    CHECK(once);
+}
+
+TEST_CASE("job_system/submit runs every job and wait sees them all finish") {
+    job_system jobs(4);
+    job_counter done;
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 10000; i++) {
+        jobs.submit([&ran] { ran.fetch_add(1); }, &done);
+    }
+    jobs.wait(done);
+    CHECK(done.is_done());
+    CHECK(done.get_pending() == 0);
+    CHECK(ran.load() == 10000);
+}
+
+TEST_CASE("job_system/submit_after only starts once the dependency is done") {
+    job_system jobs(4);
+    for (int round = 0; round < 200; round++) {
+        job_counter first;
+        job_counter second;
+        std::atomic<int> first_finished{0};
+        std::atomic<bool> started_early{false};
+        std::atomic<int> second_ran{0};
+
+        for (int i = 0; i < 8; i++) {
+            jobs.submit([&first_finished] {
+                std::this_thread::yield();
+                first_finished.fetch_add(1);
+            }, &first);
+        }
+        for (int i = 0; i < 4; i++) {
+            jobs.submit_after(first, [&] {
+                if (first_finished.load() != 8) started_early.store(true);
+                second_ran.fetch_add(1);
+            }, &second);
+        }
+        jobs.wait(second);
+
+        CHECK(!started_early.load());
+        CHECK(second_ran.load() == 4);
+        CHECK(first.is_done());
+    }
+
+    //a dependency thats already done doesnt hold the job back
+    job_counter nothing;
+    job_counter done;
+    bool ran = false;
+    jobs.submit_after(nothing, [&ran] { ran = true; }, &done);
+    jobs.wait(done);
+    CHECK(ran);
+}
+
+static bool alive_prefix_holds(const Particle::store& particles) {
+    //every particle in [0, alive_count()) is alive, and nothing past it is
+    for (int i = 0; i < particles.size(); i++) {
+        if (particles.is_alive(i) != (i < particles.alive_count())) return false;
+    }
+    return true;
+}
+
+static void fill(Particle::store& particles, std::mt19937& rng, int count) {
+    std::uniform_real_distribution<double> v(-5, 5);
+    std::uniform_real_distribution<double> life(0.01, 0.5);
+    for (int i = 0; i < count; i++) {
+        particles.spawn(kinematics{{v(rng), v(rng)}, {v(rng), v(rng)}, {v(rng) * 0.01, v(rng) * 0.01}}, life(rng), false);
+    }
+}
+
+TEST_CASE("Particle::store/alive particles stay packed at the front") {
+    std::mt19937 rng(6);
+    Particle::store particles;
+    particles.resize(1000);
+    CHECK(particles.alive_count() == 0);
+    CHECK(alive_prefix_holds(particles));
+
+    fill(particles, rng, 1200);
+    CHECK(particles.alive_count() == 1000);
+    CHECK(particles.spawn(kinematics{}, 1.0, false) == -1);
+    CHECK(particles.spawn(kinematics{}, 0.0, false) == -1);
+
+    std::uniform_int_distribution<int> spawn_count(0, 80);
+    bool holds = true;
+    for (int frame = 0; frame < 100 && holds; frame++) {
+        particles.integrate(1.0 / 60.0);
+        holds = alive_prefix_holds(particles);
+
+        //killing from the middle moves the last alive particle into the gap
+        if (particles.alive_count() > 2) {
+            particles.kill(particles.alive_count() / 2);
+            holds = holds && alive_prefix_holds(particles);
+        }
+
+        fill(particles, rng, spawn_count(rng));
+        holds = holds && alive_prefix_holds(particles);
+    }
+    CHECK(holds);
+
+    //shrinking kills everything past the new size
+    particles.resize(100);
+    CHECK(particles.alive_count() <= 100);
+    CHECK(alive_prefix_holds(particles));
+}
+
+TEST_CASE("Particle::store/updating across jobs matches updating on one thread") {
+    std::mt19937 rng(7);
+    Particle::store serial;
+    serial.resize(30000);
+    fill(serial, rng, 30000);
+    Particle::store parallel = serial;
+
+    job_system jobs(3);
+    for (int frame = 0; frame < 20; frame++) {
+        serial.integrate(1.0 / 60.0, 0.5f);
+        parallel.integrate(jobs, 1.0 / 60.0, 0.5f);
+    }
+
+    //same kernel on the same floats, so the results are bit for bit the same
+    CHECK(serial.alive_count() == parallel.alive_count());
+    CHECK(serial.pos_x == parallel.pos_x);
+    CHECK(serial.pos_y == parallel.pos_y);
+    CHECK(serial.vel_x == parallel.vel_x);
+    CHECK(serial.vel_y == parallel.vel_y);
+    CHECK(serial.life == parallel.life);
+    CHECK(alive_prefix_holds(parallel));
+}
+
+int main(int argc, char** argv) {
+    return check::run(argc, argv);
+}
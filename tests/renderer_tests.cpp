@@ -0,0 +1,99 @@
+/*
+checks that a texture destroyed while quads drawing it are still waiting in the batch gets drawn first, instead of the batch drawing a dead texture
+runs on a headless screen, so it doesnt need a display
+*/
+#include "../Celerit/Celerit.hpp"
+#include "check.hpp"
+
+#include <vector>
+
+static renderer* rend;
+
+static texture solid_texture(int w, int h, color c) {
+    texture t(*rend, w, h);
+    rend->set_render_target(t);
+    rend->fill(c);
+    rend->reset_target();
+    return t;
+}
+
+static uint32_t pixel_at(int x, int y) {
+    std::vector<uint32_t> pixels;
+    if (!rend->read_pixels(pixels)) return 0;
+    return pixels[static_cast<size_t>(y) * rend->get_screen_rect().w + x];
+}
+
+TEST_CASE("renderer/destroy_texture draws the quads still queued with it") {
+    rend->fill(BLACK);
+    texture t = solid_texture(16, 16, RED);
+    rend->set_batching(true);
+    rend->blit_texture(t, 10, 10);
+    CHECK(rend->get_batched_quads() == 1);
+
+    rend->destroy_texture(t);
+    CHECK(rend->get_batched_quads() == 0);
+    rend->set_batching(false);
+    CHECK(pixel_at(12, 12) == 0xFFFF0000u);
+}
+
+TEST_CASE("renderer/dropping the last handle to a cached texture draws the quads still queued with it") {
+    rend->fill(BLACK);
+    texture t = solid_texture(16, 16, BLUE);
+    renderer::texture_handle handle = rend->adopt_texture("blue", t.get_sdl_texture());
+    texture other = solid_texture(4, 4, GREEN);
+    rend->set_batching(true);
+    rend->blit_texture(handle.get(), 30, 10);
+
+    //an unrelated texture being destroyed leaves the batch alone
+    rend->destroy_texture(other);
+    CHECK(rend->get_batched_quads() == 1);
+
+    handle = renderer::texture_handle();
+    CHECK(rend->get_texture_cache_stats().resident_textures == 0);
+    CHECK(rend->get_batched_quads() == 0);
+    rend->set_batching(false);
+    CHECK(pixel_at(32, 12) == 0xFF0000FFu);
+}
+
+TEST_CASE("renderer/tilemaps and atlases destroyed mid frame draw their queued quads first") {
+    rend->fill(BLACK);
+    texture tileset = solid_texture(8, 8, RED);
+    rend->set_batching(true);
+    {
+        tilemap map(*rend, tileset, 8);
+        map.set_tile(0, 0, 0);
+        map.draw({-50, -50});
+        CHECK(rend->get_batched_quads() == 1);
+    }
+    CHECK(rend->get_batched_quads() == 0);
+
+    {
+        texture_atlas atlas(*rend, 64);
+        SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDL_FillRect(surf, nullptr, 0xFF00FF00u);
+        atlas_region region = atlas.add("green", surf);
+        SDL_FreeSurface(surf);
+        rend->blit_texture(region.get_texture(), region.get_source(), {{100, 50, 8, 8}});
+        CHECK(rend->get_batched_quads() == 1);
+    }
+    CHECK(rend->get_batched_quads() == 0);
+    rend->set_batching(false);
+
+    CHECK(pixel_at(52, 52) == 0xFFFF0000u);
+    CHECK(pixel_at(102, 52) == 0xFF00FF00u);
+    tileset.destroy_texture();
+}
+
+int main(int argc, char** argv) {
+    CELERIT_INIT_HEADLESS();
+    int result;
+    {
+        //the renderer has to be gone before SDL is shut down
+        screen s(320, 240, HEADLESS);
+        renderer r(s);
+        rend = &r;
+        result = check::run(argc, argv);
+    }
+    CELERIT_QUIT();
+    return result;
+}
@@ -0,0 +1,224 @@
+/*
+checks the aabb_tree and spatial_grid against a brute force search over the same rects
+*/
+#include "../Celerit/aabb_tree.hpp"
+#include "../Celerit/spatial_grid.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+static std::vector<rect> random_rects(std::mt19937& rng, int count, int world, int max_size) {
+    //rects anywhere in [-world, world), including zero sized ones and ones that only touch
+    std::uniform_int_distribution<int> pos(-world, world - 1);
+    std::uniform_int_distribution<int> size(0, max_size);
+    std::vector<rect> rects(count);
+    for (rect& r: rects) {
+        r = rect{{pos(rng), pos(rng), size(rng), size(rng)}};
+    }
+    return rects;
+}
+
+static std::vector<std::pair<int, int>> brute_force_pairs(const std::vector<rect>& rects, const std::vector<bool>& present) {
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < static_cast<int>(rects.size()); i++) {
+        for (int j = i + 1; j < static_cast<int>(rects.size()); j++) {
+            if (present[i] && present[j] && collide_rect(rects[i], rects[j])) pairs.push_back({i, j});
+        }
+    }
+    return pairs;
+}
+
+static std::vector<std::pair<int, int>> tree_pairs(aabb_tree& tree, const std::vector<rect>& rects) {
+    //turns the rect pointers back into indices, lower index first, sorted so it can be compared
+    std::vector<std::pair<int, int>> pairs;
+    for (aabb_pair& p: tree.find_pairs()) {
+        int a = static_cast<int>(p.a - rects.data());
+        int b = static_cast<int>(p.b - rects.data());
+        if (a > b) std::swap(a, b);
+        pairs.push_back({a, b});
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+TEST_CASE("aabb_tree/find_pairs matches a brute force search") {
+    std::mt19937 rng(1);
+    std::vector<rect> rects = random_rects(rng, 300, 400, 40);
+    std::vector<bool> present(rects.size(), true);
+
+    aabb_tree tree;
+    for (rect& r: rects) tree.insert(&r);
+    CHECK(tree.size() == static_cast<int>(rects.size()));
+    CHECK(tree_pairs(tree, rects) == brute_force_pairs(rects, present));
+}
+
+TEST_CASE("aabb_tree/find_pairs stays right as rects move and are removed") {
+    std::mt19937 rng(2);
+    std::vector<rect> rects = random_rects(rng, 200, 300, 30);
+    std::vector<bool> present(rects.size(), true);
+    std::vector<int> proxies;
+
+    aabb_tree tree(4.0f);
+    for (int i = 0; i < static_cast<int>(rects.size()); i++) {
+        proxies.push_back(tree.insert(&rects[i], &rects[i]));
+    }
+
+    //small moves stay inside the fat box, large ones have to move the leaf
+    std::uniform_int_distribution<int> step(-12, 12);
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(rects.size()) - 1);
+    for (int frame = 0; frame < 20; frame++) {
+        for (int i = 0; i < static_cast<int>(rects.size()); i++) {
+            if (!present[i]) continue;
+            rects[i].x += step(rng);
+            rects[i].y += step(rng);
+            tree.update(proxies[i]);
+        }
+
+        int gone = pick(rng);
+        if (present[gone]) {
+            tree.remove(proxies[gone]);
+            present[gone] = false;
+        }
+
+        CHECK(tree_pairs(tree, rects) == brute_force_pairs(rects, present));
+    }
+
+    int count = static_cast<int>(std::count(present.begin(), present.end(), true));
+    CHECK(tree.size() == count);
+
+    //the user pointer comes back with each rect
+    bool users_match = true;
+    for (aabb_pair& p: tree.find_pairs()) {
+        users_match = users_match && p.user_a == p.a && p.user_b == p.b;
+    }
+    CHECK(users_match);
+}
+
+TEST_CASE("aabb_tree/query matches a linear scan") {
+    std::mt19937 rng(3);
+    std::vector<rect> rects = random_rects(rng, 250, 500, 50);
+    aabb_tree tree;
+    for (rect& r: rects) tree.insert(&r);
+
+    for (const rect& area: random_rects(rng, 50, 500, 150)) {
+        std::vector<rect*> found;
+        tree.query(area, [&found](rect* r, void*) {
+            found.push_back(r);
+            return false;
+        });
+
+        std::vector<rect*> expected;
+        for (rect& r: rects) {
+            if (collide_rect(r, area)) expected.push_back(&r);
+        }
+
+        std::sort(found.begin(), found.end());
+        CHECK(found == expected);
+    }
+}
+
+TEST_CASE("aabb_tree/stays balanced") {
+    //rects in a line are the worst case for an unbalanced tree
+    std::vector<rect> rects(1024);
+    aabb_tree tree;
+    for (int i = 0; i < static_cast<int>(rects.size()); i++) {
+        rects[i] = rect{{i * 20, 0, 10, 10}};
+        tree.insert(&rects[i]);
+    }
+    CHECK(tree.get_height() <= 20);
+
+    tree.clear();
+    CHECK(tree.size() == 0);
+    CHECK(tree.get_height() == 0);
+    CHECK(tree.find_pairs().empty());
+}
+
+static void check_grid_against_scan(spatial_grid& grid, std::vector<rect>& rects, const std::vector<bool>& present, std::mt19937& rng) {
+    for (const rect& area: random_rects(rng, 40, 500, 200)) {
+        std::vector<rect*> found;
+        grid.query_rect(area, found);
+
+        std::vector<rect*> expected;
+        for (int i = 0; i < static_cast<int>(rects.size()); i++) {
+            if (present[i] && collide_rect(rects[i], area)) expected.push_back(&rects[i]);
+        }
+
+        //a rect spanning several cells must still only be reported once
+        std::sort(found.begin(), found.end());
+        CHECK(std::adjacent_find(found.begin(), found.end()) == found.end());
+        CHECK(found == expected);
+    }
+}
+
+TEST_CASE("spatial_grid/query_rect matches a linear scan") {
+    std::mt19937 rng(4);
+    //some rects are bigger than a cell, and half of them are at negative coordinates
+    std::vector<rect> rects = random_rects(rng, 300, 500, 150);
+    std::vector<bool> present(rects.size(), true);
+
+    spatial_grid grid(64);
+    for (rect& r: rects) grid.insert(&r);
+    CHECK(grid.size() == static_cast<int>(rects.size()));
+    check_grid_against_scan(grid, rects, present, rng);
+}
+
+TEST_CASE("spatial_grid/query_rect stays right after update, remove and set_cell_size") {
+    std::mt19937 rng(5);
+    std::vector<rect> rects = random_rects(rng, 200, 400, 100);
+    std::vector<bool> present(rects.size(), true);
+
+    spatial_grid grid(32);
+    for (rect& r: rects) grid.insert(&r);
+
+    std::uniform_int_distribution<int> step(-80, 80);
+    for (int i = 0; i < static_cast<int>(rects.size()); i += 2) {
+        rects[i].x += step(rng);
+        rects[i].y += step(rng);
+        grid.update(&rects[i]);
+    }
+    for (int i = 0; i < static_cast<int>(rects.size()); i += 5) {
+        grid.remove(&rects[i]);
+        present[i] = false;
+    }
+
+    int count = static_cast<int>(std::count(present.begin(), present.end(), true));
+    CHECK(grid.size() == count);
+    check_grid_against_scan(grid, rects, present, rng);
+
+    grid.set_cell_size(100);
+    CHECK(grid.size() == count);
+    check_grid_against_scan(grid, rects, present, rng);
+}
+
+TEST_CASE("spatial_grid/query_point finds the rects containing the point") {
+    std::vector<rect> rects = {
+        rect{{0, 0, 10, 10}},
+        rect{{-20, -20, 15, 15}},
+        rect{{60, 60, 200, 200}},
+    };
+    spatial_grid grid(16);
+    for (rect& r: rects) grid.insert(&r);
+
+    std::vector<rect*> found;
+    grid.query_point({5, 5}, found);
+    CHECK(found.size() == 1 && found[0] == &rects[0]);
+
+    found.clear();
+    grid.query_point({-10, -10}, found);
+    CHECK(found.size() == 1 && found[0] == &rects[1]);
+
+    found.clear();
+    grid.query_point({150, 150}, found);
+    CHECK(found.size() == 1 && found[0] == &rects[2]);
+
+    found.clear();
+    grid.query_point({40, 40}, found);
+    CHECK(found.empty());
+}
+
+int main(int argc, char** argv) {
+    return check::run(argc, argv);
+}
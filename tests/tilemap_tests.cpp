@@ -0,0 +1,134 @@
+/*
+checks tilemap tiles, collision and drawing against a plain map of tiles, with most of the map left of and above the origin
+runs on a headless screen, so it doesnt need a display
+*/
+#include "../Celerit/Celerit.hpp"
+#include "check.hpp"
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+static renderer* rend;
+
+static const int TILE = 8;
+
+static texture make_tileset() {
+    //two tiles side by side, 0 is red and 1 is blue
+    texture tileset(*rend, TILE * 2, TILE);
+    rend->set_render_target(tileset);
+    rend->clear_rect({{0, 0, TILE, TILE}}, RED);
+    rend->clear_rect({{TILE, 0, TILE, TILE}}, BLUE);
+    rend->reset_target();
+    return tileset;
+}
+
+TEST_CASE("tilemap/tiles read back at negative coordinates") {
+    texture tileset = make_tileset();
+    tilemap map(*rend, tileset, TILE);
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> coord(-100, 60);
+    std::uniform_int_distribution<int> id(-1, 1);
+    std::map<std::pair<int, int>, int> expected;
+    for (int i = 0; i < 3000; i++) {
+        int tx = coord(rng);
+        int ty = coord(rng);
+        int tile = id(rng);
+        map.set_tile(tx, ty, tile);
+        expected[{tx, ty}] = tile;
+    }
+
+    bool all_match = true;
+    for (int ty = -110; ty <= 70; ty++) {
+        for (int tx = -110; tx <= 70; tx++) {
+            auto found = expected.find({tx, ty});
+            int want = found == expected.end() ? -1 : found->second;
+            all_match = all_match && map.get_tile(tx, ty) == want;
+        }
+    }
+    CHECK(all_match);
+
+    //16 tile chunks, -100 to 60 spans chunks -7 to 3 on each axis
+    CHECK(map.get_chunk_count() <= 11 * 11);
+    tileset.destroy_texture();
+}
+
+TEST_CASE("tilemap/collision matches the solid tiles around the origin") {
+    texture tileset = make_tileset();
+    tilemap map(*rend, tileset, TILE);
+    map.set_solid(1);
+
+    std::mt19937 rng(12);
+    std::uniform_int_distribution<int> id(0, 2);
+    std::vector<rect> solid_tiles;
+    for (int ty = -40; ty <= 20; ty++) {
+        for (int tx = -40; tx <= 20; tx++) {
+            int tile = id(rng) == 0 ? 1 : (id(rng) == 0 ? 0 : -1);
+            map.set_tile(tx, ty, tile);
+            if (tile == 1) solid_tiles.push_back({{tx * TILE, ty * TILE, TILE, TILE}});
+        }
+    }
+
+    std::uniform_int_distribution<int> pos(-45 * TILE, 25 * TILE);
+    std::uniform_int_distribution<int> size(0, 3 * TILE);
+    bool colliding_matches = true;
+    bool query_matches = true;
+    for (int i = 0; i < 2000; i++) {
+        rect area = {{pos(rng), pos(rng), size(rng), size(rng)}};
+        bool expected = false;
+        for (rect& t: solid_tiles) expected = expected || collide_rect(t, area);
+
+        colliding_matches = colliding_matches && map.is_colliding(area) == expected;
+
+        std::vector<rect*> found;
+        map.query_rect(area, found);
+        query_matches = query_matches && found.empty() == !expected;
+    }
+    CHECK(colliding_matches);
+    CHECK(query_matches);
+    tileset.destroy_texture();
+}
+
+TEST_CASE("tilemap/chunks left of and above the origin are drawn") {
+    texture tileset = make_tileset();
+    tilemap map(*rend, tileset, TILE);
+    //one tile in chunk -1, -1 and one in chunk -2, 0
+    map.set_tile(-3, -3, 0);
+    map.set_tile(-20, 1, 1);
+
+    rect screen_rect = rend->get_screen_rect();
+    std::vector<uint32_t> pixels;
+    auto pixel_at = [&](int x, int y) {
+        return pixels[static_cast<size_t>(y) * screen_rect.w + x];
+    };
+
+    //with the scroll at -200, -100 world pixel (x, y) is on screen at (x + 200, y + 100)
+    rend->fill(BLACK);
+    map.draw({-200, -100});
+    if (!CHECK(rend->read_pixels(pixels))) return;
+    CHECK(pixel_at(-3 * TILE + 200 + 1, -3 * TILE + 100 + 1) == 0xFFFF0000u);
+    CHECK(pixel_at(-20 * TILE + 200 + 1, 1 * TILE + 100 + 1) == 0xFF0000FFu);
+    CHECK(pixel_at(200 + 1, 100 + 1) == 0xFF000000u);
+    CHECK(map.get_chunks_rendered() == 2);
+
+    //drawing again reuses the chunk textures
+    map.draw({-200, -100});
+    CHECK(map.get_chunks_rendered() == 2);
+    tileset.destroy_texture();
+}
+
+int main(int argc, char** argv) {
+    CELERIT_INIT_HEADLESS();
+    int result;
+    {
+        //the renderer has to be gone before SDL is shut down
+        screen s(320, 240, HEADLESS);
+        renderer r(s);
+        rend = &r;
+        result = check::run(argc, argv);
+    }
+    CELERIT_QUIT();
+    return result;
+}
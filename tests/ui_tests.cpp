@@ -0,0 +1,74 @@
+/*
+checks canvas::element_at picks the topmost element under a point, and that elements without bounds of their own dont cover the others
+runs on a headless screen, so it doesnt need a display
+*/
+#include "../Celerit/Celerit.hpp"
+#include "check.hpp"
+
+static renderer* rend;
+
+//an element that overrides neither get_bounds nor hit_test
+class unbounded_element : public CUIElement {
+    public:
+    void draw() override {}
+};
+
+//an element that only overrides hit_test, a circle of radius 10 around 200, 150
+class circle_element : public CUIElement {
+    public:
+    void draw() override {}
+
+    bool hit_test(dvec2 point) override {
+        double dx = point.x - 200;
+        double dy = point.y - 150;
+        return dx * dx + dy * dy <= 100;
+    }
+};
+
+TEST_CASE("canvas/element_at finds the topmost button") {
+    canvas c(*rend, {0, 0});
+    button* lower = c.create_UI_element(button(*rend, RED, BLUE, {{40, 40, 40, 40}}));
+    button* upper = c.create_UI_element(button(*rend, GREEN, BLUE, {{60, 60, 40, 40}}));
+
+    CHECK(c.element_at({50, 50}) == lower);
+    CHECK(c.element_at({70, 70}) == upper);
+    CHECK(c.element_at({90, 90}) == upper);
+    CHECK(c.element_at({10, 10}) == nullptr);
+    CHECK(c.element_at({150, 150}) == nullptr);
+}
+
+TEST_CASE("canvas/an element without bounds doesnt cover the buttons under it") {
+    canvas c(*rend, {0, 0});
+    button* b = c.create_UI_element(button(*rend, RED, BLUE, {{40, 40, 40, 40}}));
+    c.create_UI_element(unbounded_element());
+
+    CHECK(c.element_at({50, 50}) == b);
+    CHECK(c.element_at({10, 10}) == nullptr);
+    CHECK(c.element_at({300, 200}) == nullptr);
+    CHECK(!c.hit_test({10, 10}));
+}
+
+TEST_CASE("canvas/an element that only overrides hit_test is still found") {
+    canvas c(*rend, {0, 0});
+    button* b = c.create_UI_element(button(*rend, RED, BLUE, {{40, 40, 40, 40}}));
+    circle_element* circle = c.create_UI_element(circle_element());
+
+    CHECK(c.element_at({200, 150}) == circle);
+    CHECK(c.element_at({205, 155}) == circle);
+    CHECK(c.element_at({215, 150}) == nullptr);
+    CHECK(c.element_at({50, 50}) == b);
+}
+
+int main(int argc, char** argv) {
+    CELERIT_INIT_HEADLESS();
+    int result;
+    {
+        //the renderer has to be gone before SDL is shut down
+        screen s(320, 240, HEADLESS);
+        renderer r(s);
+        rend = &r;
+        result = check::run(argc, argv);
+    }
+    CELERIT_QUIT();
+    return result;
+}
@@ -0,0 +1,114 @@
+/*
+packs files into an asset archive that Celerit's asset_archive can memory map
+
+    celerit_pack <output.pak> <file or directory>...
+
+files are named by the path they were given with, files found in a directory are named relative to that directory,
+so "celerit_pack assets.pak assets" packs assets/props/tree.png as "props/tree.png"
+*/
+#include "../Celerit/asset_archive.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct pack_input {
+    fs::path file;
+    string name;
+};
+
+static void collect(const fs::path& arg, std::vector<pack_input>& out) {
+    //adds a file, or every file under a directory
+    if (fs::is_directory(arg)) {
+        for (const fs::directory_entry& e: fs::recursive_directory_iterator(arg)) {
+            if (e.is_regular_file()) out.push_back({e.path(), fs::relative(e.path(), arg).generic_string()});
+        }
+    } else if (fs::is_regular_file(arg)) {
+        out.push_back({arg, arg.generic_string()});
+    } else {
+        cerr << "Error: " << arg << " is not a file or directory\n";
+        exit(-1);
+    }
+}
+
+static void write_u32(std::ostream& os, uint32_t v) {
+    archive_format::put_le(os, v);
+}
+
+static void write_u64(std::ostream& os, uint64_t v) {
+    archive_format::put_le(os, v);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "usage: " << argv[0] << " <output.pak> <file or directory>...\n";
+        return 1;
+    }
+
+    std::vector<pack_input> inputs;
+    for (int i = 2; i < argc; i++) collect(argv[i], inputs);
+    //sorted so packing the same files twice gives the same archive
+    std::sort(inputs.begin(), inputs.end(), [](const pack_input& a, const pack_input& b) { return a.name < b.name; });
+    for (size_t i = 1; i < inputs.size(); i++) {
+        if (inputs[i].name == inputs[i - 1].name) {
+            cerr << "Error: " << inputs[i].name << " was given twice\n";
+            return 1;
+        }
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    if (!out) {
+        cerr << "Error: could not write " << argv[1] << "\n";
+        return 1;
+    }
+
+    //the header is written again at the end once the table of contents is placed
+    archive_format::header h = {};
+    memcpy(h.magic, archive_format::MAGIC, sizeof(h.magic));
+    h.version = archive_format::VERSION;
+    h.entry_count = (uint32_t)inputs.size();
+    archive_format::write_header(out, h);
+
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> sizes;
+    std::vector<char> buffer;
+    for (const pack_input& in: inputs) {
+        //pad up to the alignment so every file starts on a nice boundary
+        uint64_t at = (uint64_t)out.tellp();
+        uint64_t aligned = (at + archive_format::DATA_ALIGN - 1) / archive_format::DATA_ALIGN * archive_format::DATA_ALIGN;
+        for (uint64_t i = at; i < aligned; i++) out.put('\0');
+
+        std::ifstream file(in.file, std::ios::binary);
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!file.good() && !file.eof()) {
+            cerr << "Error: could not read " << in.file << "\n";
+            return 1;
+        }
+        offsets.push_back(aligned);
+        sizes.push_back(buffer.size());
+        out.write(buffer.data(), (std::streamsize)buffer.size());
+    }
+
+    h.toc_offset = (uint64_t)out.tellp();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        write_u64(out, offsets[i]);
+        write_u64(out, sizes[i]);
+        write_u32(out, (uint32_t)inputs[i].name.size());
+        out.write(inputs[i].name.data(), (std::streamsize)inputs[i].name.size());
+    }
+    h.toc_size = (uint64_t)out.tellp() - h.toc_offset;
+
+    out.seekp(0);
+    archive_format::write_header(out, h);
+    if (!out) {
+        cerr << "Error: could not write " << argv[1] << "\n";
+        return 1;
+    }
+
+    cout << "packed " << inputs.size() << " files into " << argv[1] << " (" << h.toc_offset + h.toc_size << " bytes)\n";
+    return 0;
+}